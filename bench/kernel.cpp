@@ -0,0 +1,53 @@
+#include <squeeze.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace squeeze;
+
+template <class F>
+double measure(int iterations, F&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        f();
+    }
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int main()
+{
+    const size_t size = 100000;
+    const int iterations = 20;
+
+    HVM vm;
+    vm.open(1024);
+    vm.kernellib();
+
+    HScript script(vm);
+    HTable env(vm);
+
+    script.compileFile(SQZ_T("kernel.nut"));
+    script.run(env);
+
+    std::vector<float> a(size, 1.0f);
+    std::vector<float> b(size, 0.5f);
+    const BufferRef<float> bufA(a.data(), a.size());
+    const BufferRef<float> bufB(b.data(), b.size());
+
+    std::printf("%zu float elements, microseconds per call\n", size);
+    std::printf("%-8s %12s %12s\n", "", "script loop", "kernel");
+    std::printf("%-8s %12.1f %12.1f\n", "scale",
+        measure(iterations, [&] { env.call<void>(SQZ_T("loopscale"), env, bufA, 1.0f); }),
+        measure(iterations, [&] { env.call<void>(SQZ_T("kernelscale"), env, bufA, 1.0f); }));
+    std::printf("%-8s %12.1f %12.1f\n", "dot",
+        measure(iterations, [&] { env.call<float>(SQZ_T("loopdot"), env, bufA, bufB); }),
+        measure(iterations, [&] { env.call<float>(SQZ_T("kerneldot"), env, bufA, bufB); }));
+
+    env.release();
+    script.release();
+    vm.close();
+    return 0;
+}
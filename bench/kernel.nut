@@ -0,0 +1,29 @@
+function loopscale(b, k)
+{
+    local n = b.len()
+    for (local i = 0; i < n; ++i)
+    {
+        b[i] *= k
+    }
+}
+
+function loopdot(a, b)
+{
+    local sum = 0.0
+    local n = a.len()
+    for (local i = 0; i < n; ++i)
+    {
+        sum += a[i] * b[i]
+    }
+    return sum
+}
+
+function kernelscale(b, k)
+{
+    kernel.scale(b, k)
+}
+
+function kerneldot(a, b)
+{
+    return kernel.dot(a, b)
+}
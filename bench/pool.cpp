@@ -0,0 +1,61 @@
+#include <squeeze.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using namespace squeeze;
+
+void initialize(HVM& vm)
+{
+    vm.bloblib();
+    vm.iolib();
+    vm.mathlib();
+    vm.stringlib();
+    vm.systemlib();
+
+    auto root = vm.rootTable();
+    auto batch = root.batch();
+    for (int i = 0; i < 500; ++i)
+    {
+        string_t name = SQZ_T("f");
+        for (const auto c : std::to_string(i))
+        {
+            name += static_cast<SQChar>(c);
+        }
+        batch.fun(name, [](int n) { return n + 1; });
+    }
+}
+
+template <class F>
+double measure(int iterations, F&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        f();
+    }
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int main()
+{
+    const double construct = measure(20, []
+    {
+        HVM vm;
+        vm.open(1024);
+        initialize(vm);
+        vm.close();
+    });
+
+    HVMPool pool(4, 1024, initialize);
+    const double lease = measure(100000, [&pool]
+    {
+        auto l = pool.lease();
+    });
+
+    std::printf("microseconds per VM\n");
+    std::printf("%-24s %12.3f\n", "construct and initialize", construct);
+    std::printf("%-24s %12.3f\n", "lease and return", lease);
+    return 0;
+}
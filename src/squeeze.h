@@ -14,12 +14,21 @@ Otherwise (default), Squeeze use float type.
 #include "sqzdef.h"
 #include "sqzutil.h"
 #include "sqzscript.h"
+#include "sqzbytecode.h"
+#include "sqzbundle.h"
+#include "sqzprecompile.h"
 #include "sqzclass.h"
 #include "sqztable.h"
+#include "sqzarray.h"
+#include "sqzbuffer.h"
+#include "sqzkernel.h"
+#include "sqzfunction.h"
 #include "sqzobject.h"
+#include "sqzkey.h"
 #include "sqztableimpl.h"
 #include "sqzclosure.h"
 #include "sqzvm.h"
+#include "sqzpool.h"
 #include "sqzstackop.h"
 
 #include "sqzimpl.h"
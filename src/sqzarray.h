@@ -0,0 +1,193 @@
+#ifndef SQUEEZE_SQZARRAY_H
+#define SQUEEZE_SQZARRAY_H
+
+#include "sqzobject.h"
+#include "sqzstackop.h"
+#include "sqzvm.h"
+#include "sqzdef.h"
+#include "sqzutil.h"
+#include <squirrel.h>
+#include <iterator>
+#include <vector>
+
+namespace squeeze
+{
+    /** The Array object handle */
+    class HArray : public HObject
+    {
+    public:
+        /** Construct */
+        HArray() = default;
+
+        /** Create an array object which has 'size' null elements */
+        explicit HArray(HVM vm, SQInteger size = 0)
+        {
+            vm_ = vm;
+            const auto top = sq_gettop(vm_);
+            sq_newarray(vm_, size);
+            sq_getstackobj(vm_, -1, &obj_);
+            sq_addref(vm_, &obj_);
+            sq_settop(vm_, top);
+        }
+
+        /** Create with copy the object handle */
+        HArray(HVM vm, HSQOBJECT obj)
+        {
+            vm_ = vm;
+            obj_ = obj;
+            sq_addref(vm_, &obj_);
+        }
+
+        /** Return the number of elements */
+        SQInteger size()
+        {
+            const auto top = sq_gettop(vm_);
+            sq_pushobject(vm_, obj_);
+            const auto size = sq_getsize(vm_, -1);
+            sq_settop(vm_, top);
+            return size;
+        }
+
+        /** Append a value. */
+        template <class T>
+        HArray& push(const T& val)
+        {
+            const auto top = sq_gettop(vm_);
+            pushValue(vm_, obj_, val);
+            if (SQ_FAILED(sq_arrayappend(vm_, -2)))
+            {
+                sq_settop(vm_, top);
+                failed<ObjectHandlingFailed>(vm_, "sq_arrayappend() failed.");
+            }
+            sq_settop(vm_, top);
+            return *this;
+        }
+
+        /** Remove the last value and return it. */
+        template <class T>
+        T pop()
+        {
+            const auto top = sq_gettop(vm_);
+            sq_pushobject(vm_, obj_);
+            if (SQ_FAILED(sq_arraypop(vm_, -1, SQTrue)))
+            {
+                sq_settop(vm_, top);
+                failed<ObjectHandlingFailed>(vm_, "sq_arraypop() failed.");
+            }
+            try
+            {
+                auto val = getValue<T>(vm_, -1);
+                sq_settop(vm_, top);
+                return val;
+            }
+            catch (...)
+            {
+                sq_settop(vm_, top);
+                throw;
+            }
+        }
+
+        /** Change the number of elements. New elements are null. */
+        HArray& resize(SQInteger size)
+        {
+            const auto top = sq_gettop(vm_);
+            sq_pushobject(vm_, obj_);
+            if (SQ_FAILED(sq_arrayresize(vm_, -1, size)))
+            {
+                sq_settop(vm_, top);
+                failed<ObjectHandlingFailed>(vm_, "sq_arrayresize() failed.");
+            }
+            sq_settop(vm_, top);
+            return *this;
+        }
+
+        /** Return the value at 'index'. */
+        template <class T>
+        T at(SQInteger index)
+        {
+            const auto top = sq_gettop(vm_);
+            pushValue(vm_, obj_, index);
+            if (SQ_FAILED(sq_rawget(vm_, -2)))
+            {
+                sq_settop(vm_, top);
+                failed<ObjectHandlingFailed>(vm_, "sq_rawget() failed.");
+            }
+            try
+            {
+                auto val = getValue<T>(vm_, -1);
+                sq_settop(vm_, top);
+                return val;
+            }
+            catch (...)
+            {
+                sq_settop(vm_, top);
+                throw;
+            }
+        }
+
+        /** Replace the value at 'index'. */
+        template <class T>
+        HArray& set(SQInteger index, const T& val)
+        {
+            const auto top = sq_gettop(vm_);
+            pushValue(vm_, obj_, index, val);
+            if (SQ_FAILED(sq_rawset(vm_, -3)))
+            {
+                sq_settop(vm_, top);
+                failed<ObjectHandlingFailed>(vm_, "sq_rawset() failed.");
+            }
+            sq_settop(vm_, top);
+            return *this;
+        }
+
+        /**
+        Replace all elements with values of a range.
+        The array is resized once and filled in one stack session.
+        */
+        template <class It>
+        HArray& assign(It first, It last)
+        {
+            const auto size = static_cast<SQInteger>(std::distance(first, last));
+            const auto top = sq_gettop(vm_);
+            sq_pushobject(vm_, obj_);
+            if (SQ_FAILED(sq_arrayresize(vm_, -1, size)))
+            {
+                sq_settop(vm_, top);
+                failed<ObjectHandlingFailed>(vm_, "sq_arrayresize() failed.");
+            }
+            for (SQInteger i = 0; i < size; ++i, ++first)
+            {
+                sq_pushinteger(vm_, i);
+                pushValue(vm_, *first);
+                sq_rawset(vm_, -3);
+            }
+            sq_settop(vm_, top);
+            return *this;
+        }
+
+        /**
+        Copy elements to a contiguous range in one stack session.
+        Return the number of copied elements, which is not greater than the size of 'out'.
+        */
+        template <class T>
+        SQInteger copyTo(Span<T> out)
+        {
+            const auto top = sq_gettop(vm_);
+            sq_pushobject(vm_, obj_);
+            const auto size = std::min(sq_getsize(vm_, -1), static_cast<SQInteger>(out.size()));
+            detail::getArray<std::remove_cv_t<T>>(vm_, sq_gettop(vm_), size, out.begin());
+            sq_settop(vm_, top);
+            return size;
+        }
+
+        /// ditto
+        template <class T>
+        SQInteger copyTo(std::vector<T>& out)
+        {
+            out.resize(static_cast<size_t>(size()));
+            return copyTo(Span<T>(out));
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef SQUEEZE_SQZBUFFER_H
+#define SQUEEZE_SQZBUFFER_H
+
+#include "sqzstackop.h"
+#include "sqzdef.h"
+#include "sqzutil.h"
+#include <squirrel.h>
+#include <type_traits>
+#include <utility>
+
+namespace squeeze
+{
+    namespace detail
+    {
+        /** The metamethods of numeric buffers */
+        struct BufferClosure
+        {
+            static BufferData* self(HSQUIRRELVM vm)
+            {
+                SQUserPointer p;
+                SQUserPointer tag;
+                if (SQ_FAILED(sq_getuserdata(vm, 1, &p, &tag)) || tag != typeTag<BufferData>())
+                {
+                    return nullptr;
+                }
+                return static_cast<BufferData*>(p);
+            }
+
+            static SQInteger get(HSQUIRRELVM vm)
+            {
+                const auto buf = self(vm);
+                if (!buf)
+                {
+                    return sq_throwerror(vm, SQZ_T("The object is not a buffer."));
+                }
+                if (sq_gettype(vm, 2) != OT_INTEGER)
+                {
+                    // Throwing null means the slot is not found.
+                    sq_pushnull(vm);
+                    return sq_throwobject(vm);
+                }
+
+                SQInteger i;
+                sq_getinteger(vm, 2, &i);
+                if (i < 0 || i >= buf->size)
+                {
+                    return sq_throwerror(vm, SQZ_T("The index is out of range."));
+                }
+
+                switch (buf->type)
+                {
+                case BufferType::Float32: sq_pushfloat(vm, static_cast<SQFloat>(static_cast<const float*>(buf->data)[i])); break;
+                case BufferType::Float64: sq_pushfloat(vm, static_cast<SQFloat>(static_cast<const double*>(buf->data)[i])); break;
+                case BufferType::Int32: sq_pushinteger(vm, static_cast<SQInteger>(static_cast<const std::int32_t*>(buf->data)[i])); break;
+                case BufferType::UInt8: sq_pushinteger(vm, static_cast<SQInteger>(static_cast<const std::uint8_t*>(buf->data)[i])); break;
+                }
+                return 1;
+            }
+
+            static SQInteger set(HSQUIRRELVM vm)
+            {
+                const auto buf = self(vm);
+                if (!buf)
+                {
+                    return sq_throwerror(vm, SQZ_T("The object is not a buffer."));
+                }
+                if (buf->readOnly)
+                {
+                    return sq_throwerror(vm, SQZ_T("The buffer is read-only."));
+                }
+                if (sq_gettype(vm, 2) != OT_INTEGER)
+                {
+                    sq_pushnull(vm);
+                    return sq_throwobject(vm);
+                }
+
+                SQInteger i;
+                sq_getinteger(vm, 2, &i);
+                if (i < 0 || i >= buf->size)
+                {
+                    return sq_throwerror(vm, SQZ_T("The index is out of range."));
+                }
+
+                SQFloat f;
+                SQInteger n;
+                if (SQ_FAILED(sq_getfloat(vm, 3, &f)) || SQ_FAILED(sq_getinteger(vm, 3, &n)))
+                {
+                    return sq_throwerror(vm, SQZ_T("The value is not a number."));
+                }
+
+                switch (buf->type)
+                {
+                case BufferType::Float32: static_cast<float*>(buf->data)[i] = static_cast<float>(f); break;
+                case BufferType::Float64: static_cast<double*>(buf->data)[i] = static_cast<double>(f); break;
+                case BufferType::Int32: static_cast<std::int32_t*>(buf->data)[i] = static_cast<std::int32_t>(n); break;
+                case BufferType::UInt8: static_cast<std::uint8_t*>(buf->data)[i] = static_cast<std::uint8_t>(n); break;
+                }
+                return 0;
+            }
+
+            static SQInteger nexti(HSQUIRRELVM vm)
+            {
+                const auto buf = self(vm);
+                if (!buf)
+                {
+                    return sq_throwerror(vm, SQZ_T("The object is not a buffer."));
+                }
+
+                SQInteger next = 0;
+                if (sq_gettype(vm, 2) != OT_NULL)
+                {
+                    SQInteger prev;
+                    if (SQ_FAILED(sq_getinteger(vm, 2, &prev)))
+                    {
+                        return sq_throwerror(vm, SQZ_T("The index is not an integer."));
+                    }
+                    next = prev + 1;
+                }
+
+                if (next < buf->size)
+                {
+                    sq_pushinteger(vm, next);
+                }
+                else
+                {
+                    sq_pushnull(vm);
+                }
+                return 1;
+            }
+
+            static SQInteger len(HSQUIRRELVM vm)
+            {
+                const auto buf = self(vm);
+                if (!buf)
+                {
+                    return sq_throwerror(vm, SQZ_T("The object is not a buffer."));
+                }
+                sq_pushinteger(vm, buf->size);
+                return 1;
+            }
+        };
+
+        /** Push the delegate table of numeric buffers, which is created once per VM. */
+        inline void pushBufferDelegate(HSQUIRRELVM vm)
+        {
+            sq_pushregistrytable(vm);
+            sq_pushuserpointer(vm, typeTag<BufferData>());
+            if (SQ_FAILED(sq_rawget(vm, -2)))
+            {
+                sq_newtableex(vm, 4);
+
+                const std::pair<const SQChar*, SQFUNCTION> methods[] =
+                {
+                    { SQZ_T("_get"), BufferClosure::get },
+                    { SQZ_T("_set"), BufferClosure::set },
+                    { SQZ_T("_nexti"), BufferClosure::nexti },
+                    { SQZ_T("len"), BufferClosure::len },
+                };
+                for (const auto& m : methods)
+                {
+                    sq_pushstring(vm, m.first, -1);
+                    sq_newclosure(vm, m.second, 0);
+                    sq_newslot(vm, -3, SQFalse);
+                }
+
+                sq_pushuserpointer(vm, typeTag<BufferData>());
+                sq_push(vm, -2);
+                sq_rawset(vm, -4);
+            }
+            sq_remove(vm, -2); // Remove the registry table.
+        }
+    }
+
+    /**
+    Push a user data which refers to a numeric buffer without copying the elements.
+    The user data shares the pin of the buffer until it is released.
+    */
+    template <class T>
+    void pushBuffer(HSQUIRRELVM vm, const BufferRef<T>& buf)
+    {
+        newUserData<detail::BufferData>(vm, detail::BufferData{
+            const_cast<std::remove_const_t<T>*>(buf.data),
+            static_cast<SQInteger>(buf.size),
+            BufferTypeOf<T>::value,
+            std::is_const<T>::value,
+            buf.pin });
+        detail::pushBufferDelegate(vm);
+        sq_setdelegate(vm, -2);
+    }
+
+    /** Push the values into the stack. */
+    template <class T, class... Ts>
+    void pushValue(HSQUIRRELVM vm, const BufferRef<T>& val, Ts&&... values)
+    {
+        pushBuffer(vm, val);
+        pushValue(vm, std::forward<Ts>(values)...);
+    }
+}
+
+#endif
@@ -0,0 +1,271 @@
+#ifndef SQUEEZE_SQZBUNDLE_H
+#define SQUEEZE_SQZBUNDLE_H
+
+#include "sqzscript.h"
+#include "sqzbytecode.h"
+#include "sqzvm.h"
+#include "sqzdef.h"
+#include <squirrel.h>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace squeeze
+{
+    namespace detail
+    {
+        /** The magic number at the head of bundles */
+        constexpr char bundleMagic[4] = { 'S', 'Q', 'Z', 'B' };
+
+        /** The version of the bundle format */
+        constexpr std::uint32_t bundleFormat = 1;
+
+        /**
+        Map a whole file read-only, and return the handle to unmap it. Throw if the file can not be mapped.
+        This is defined in sqzmapping.h, which keeps the platform headers out of squeeze.h.
+        */
+        void* mapFile(const std::filesystem::path& path, const unsigned char*& data, size_t& size);
+
+        /** Unmap a file mapped by mapFile(). This is defined in sqzmapping.h. */
+        void unmapFile(const unsigned char* data, size_t size, void* handle);
+
+        /** A read-only file mapped into the memory */
+        class MappedFile
+        {
+        private:
+            const unsigned char* data_ = nullptr;
+            size_t size_ = 0;
+            void* handle_ = nullptr;
+
+        public:
+            /** Map a whole file */
+            explicit MappedFile(const std::filesystem::path& path)
+            {
+                handle_ = mapFile(path, data_, size_);
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            /** Unmap */
+            ~MappedFile()
+            {
+                unmapFile(data_, size_, handle_);
+            }
+
+            /** Return the head of the mapped bytes */
+            const unsigned char* data() const
+            {
+                return data_;
+            }
+
+            /** Return the number of the mapped bytes */
+            size_t size() const
+            {
+                return size_;
+            }
+        };
+
+        /** Append a value to bytes in the native layout */
+        template <class T>
+        void appendRaw(std::vector<unsigned char>& bytes, const T& val)
+        {
+            const auto p = reinterpret_cast<const unsigned char*>(&val);
+            bytes.insert(bytes.end(), p, p + sizeof(T));
+        }
+
+        /** Read a value in the native layout. Return false if the bytes are too short. */
+        template <class T>
+        bool readRaw(const unsigned char*& p, const unsigned char* end, T& val)
+        {
+            if (static_cast<size_t>(end - p) < sizeof(T))
+            {
+                return false;
+            }
+            std::memcpy(&val, p, sizeof(T));
+            p += sizeof(T);
+            return true;
+        }
+    }
+
+    /**
+    The writer of bundles, which pack compiled scripts into one file.
+    A bundle has a header, an index of module names, and bytecode of modules in the order of names.
+    */
+    class BundleWriter
+    {
+    private:
+        std::map<string_t, std::vector<unsigned char>> modules_;
+
+    public:
+        /** Add bytecode of a module. A module which has the same name is replaced. */
+        BundleWriter& add(const string_t& name, std::vector<unsigned char> bytecode)
+        {
+            modules_[name] = std::move(bytecode);
+            return *this;
+        }
+
+        /// ditto
+        BundleWriter& add(const string_t& name, HScript& script)
+        {
+            return add(name, script.saveBytecode());
+        }
+
+        /** Return the number of modules */
+        size_t size() const
+        {
+            return modules_.size();
+        }
+
+        /** Return the bytes of the bundle */
+        std::vector<unsigned char> bytes() const
+        {
+            std::vector<unsigned char> bytes(detail::bundleMagic, detail::bundleMagic + sizeof(detail::bundleMagic));
+            detail::appendRaw(bytes, detail::bundleFormat);
+            detail::appendRaw(bytes, detail::configHash());
+            detail::appendRaw(bytes, static_cast<std::uint32_t>(modules_.size()));
+
+            // Bytecode follows the index, so offsets are known after the size of the index is known.
+            std::uint64_t offset = bytes.size();
+            for (const auto& m : modules_)
+            {
+                offset += sizeof(std::uint32_t) + sizeof(std::uint64_t) * 2 + m.first.length() * sizeof(SQChar);
+            }
+            for (const auto& m : modules_)
+            {
+                detail::appendRaw(bytes, static_cast<std::uint32_t>(m.first.length()));
+                detail::appendRaw(bytes, offset);
+                detail::appendRaw(bytes, static_cast<std::uint64_t>(m.second.size()));
+                const auto name = reinterpret_cast<const unsigned char*>(m.first.data());
+                bytes.insert(bytes.end(), name, name + m.first.length() * sizeof(SQChar));
+                offset += m.second.size();
+            }
+            for (const auto& m : modules_)
+            {
+                bytes.insert(bytes.end(), m.second.begin(), m.second.end());
+            }
+            return bytes;
+        }
+
+        /** Write the bundle to a file. The file is replaced atomically. */
+        void write(const std::filesystem::path& path) const
+        {
+            if (!detail::writeFile(path, bytes()))
+            {
+                throw ScriptException("The bundle can not be written.");
+            }
+        }
+    };
+
+    /**
+    The bundle of compiled scripts, which is mapped into the memory.
+    Opening reads only the index, and bytecode of a module is read when the module is loaded.
+    A bundle can be shared by VMs in multiple threads.
+    A program which opens bundles includes sqzmapping.h in one of its source files.
+    */
+    class HBundle
+    {
+    private:
+        std::shared_ptr<const detail::MappedFile> file_;
+        std::unordered_map<string_t, Span<const unsigned char>> index_;
+
+        [[noreturn]] static void broken()
+        {
+            throw ScriptException("The bundle is broken or built for another configuration.");
+        }
+
+    public:
+        /** Construct */
+        HBundle() = default;
+
+        /** Map a bundle file and read its index. */
+        explicit HBundle(const std::filesystem::path& path)
+            : file_(std::make_shared<const detail::MappedFile>(path))
+            , index_()
+        {
+            const auto begin = file_->data();
+            const auto end = begin + file_->size();
+            auto p = begin;
+
+            char magic[sizeof(detail::bundleMagic)];
+            std::uint32_t format;
+            std::uint64_t config;
+            std::uint32_t count;
+            if (!detail::readRaw(p, end, magic) || std::memcmp(magic, detail::bundleMagic, sizeof(magic)) != 0 ||
+                !detail::readRaw(p, end, format) || format != detail::bundleFormat ||
+                !detail::readRaw(p, end, config) || config != detail::configHash() ||
+                !detail::readRaw(p, end, count))
+            {
+                broken();
+            }
+
+            index_.reserve(count);
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                std::uint32_t length;
+                std::uint64_t offset;
+                std::uint64_t size;
+                if (!detail::readRaw(p, end, length) || !detail::readRaw(p, end, offset) || !detail::readRaw(p, end, size) ||
+                    static_cast<size_t>(end - p) < length * sizeof(SQChar) ||
+                    offset > file_->size() || size > file_->size() - offset)
+                {
+                    broken();
+                }
+
+                string_t name(length, SQChar());
+                std::memcpy(&name[0], p, length * sizeof(SQChar));
+                p += length * sizeof(SQChar);
+                index_.emplace(std::move(name), Span<const unsigned char>(begin + offset, static_cast<size_t>(size)));
+            }
+        }
+
+        /** Return the number of modules */
+        size_t size() const
+        {
+            return index_.size();
+        }
+
+        /** Whether the bundle has a module or not */
+        bool has(const string_t& name) const
+        {
+            return index_.find(name) != index_.end();
+        }
+
+        /** Return the names of modules */
+        std::vector<string_t> names() const
+        {
+            std::vector<string_t> names;
+            names.reserve(index_.size());
+            for (const auto& m : index_)
+            {
+                names.push_back(m.first);
+            }
+            return names;
+        }
+
+        /** Return the bytecode of a module, which refers to the mapped memory. */
+        Span<const unsigned char> bytecode(const string_t& name) const
+        {
+            const auto it = index_.find(name);
+            if (it == index_.end())
+            {
+                throw ScriptException("The module is not found in the bundle.");
+            }
+            return it->second;
+        }
+
+        /** Load a module into a VM. */
+        HScript load(HVM vm, const string_t& name) const
+        {
+            HScript script(vm);
+            script.loadBytecode(bytecode(name));
+            return script;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef SQUEEZE_SQZBYTECODE_H
+#define SQUEEZE_SQZBYTECODE_H
+
+#include "sqzdef.h"
+#include "sqzutil.h"
+#include <squirrel.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <system_error>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace squeeze
+{
+    namespace detail
+    {
+        /** The reader of sq_readclosure() which reads from a memory */
+        struct MemoryReader
+        {
+            const unsigned char* p;
+            size_t size;
+            size_t pos;
+
+            static SQInteger read(SQUserPointer up, SQUserPointer buf, SQInteger size)
+            {
+                const auto reader = static_cast<MemoryReader*>(up);
+                const auto n = std::min(static_cast<size_t>(size), reader->size - reader->pos);
+                std::memcpy(buf, reader->p + reader->pos, n);
+                reader->pos += n;
+                return n == static_cast<size_t>(size) ? size : -1;
+            }
+        };
+
+        /** The writer of sq_writeclosure() which appends to a memory */
+        struct MemoryWriter
+        {
+            std::vector<unsigned char>* out;
+
+            static SQInteger write(SQUserPointer up, SQUserPointer buf, SQInteger size)
+            {
+                const auto writer = static_cast<MemoryWriter*>(up);
+                const auto p = static_cast<const unsigned char*>(buf);
+                writer->out->insert(writer->out->end(), p, p + size);
+                return size;
+            }
+        };
+
+        /** The reader of sq_compile() which calls a function object */
+        template <class Reader>
+        struct LexReader
+        {
+            static SQInteger read(SQUserPointer up)
+            {
+                return (*static_cast<Reader*>(up))();
+            }
+        };
+
+        /** The 64-bit FNV-1a hash */
+        inline std::uint64_t hash(const void* data, size_t size, std::uint64_t h = 14695981039346656037ull)
+        {
+            const auto p = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+                h = (h ^ p[i]) * 1099511628211ull;
+            }
+            return h;
+        }
+
+        /** Return the hash of the versions and the configuration which bytecode depends on */
+        inline std::uint64_t configHash()
+        {
+            const std::uint32_t config[] =
+            {
+                SQUEEZE_VERSION_NUMBER,
+                SQUIRREL_VERSION_NUMBER,
+                static_cast<std::uint32_t>(sizeof(SQChar)),
+                static_cast<std::uint32_t>(sizeof(SQInteger)),
+                static_cast<std::uint32_t>(sizeof(SQFloat)),
+            };
+            return hash(config, sizeof(config));
+        }
+
+        /** Read all bytes of a file. Return false if the file can not be read. */
+        inline bool readFile(const std::filesystem::path& path, std::vector<unsigned char>& bytes)
+        {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file)
+            {
+                return false;
+            }
+            bytes.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            return static_cast<bool>(file.read(reinterpret_cast<char*>(bytes.data()), bytes.size()));
+        }
+
+        /**
+        Write all bytes to a file. Return false if the file can not be written.
+        The bytes are written to a temporary file and renamed, so readers never see a partial file.
+        The name of the temporary file has a random suffix, so writers in other processes do not share it.
+        */
+        inline bool writeFile(const std::filesystem::path& path, const std::vector<unsigned char>& bytes)
+        {
+            const auto id = std::hash<std::thread::id>()(std::this_thread::get_id());
+            const auto suffix = std::random_device()();
+            auto temp = path;
+            temp += "." + std::to_string(id) + "." + std::to_string(suffix) + ".tmp";
+            {
+                std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+                if (!file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size()))
+                {
+                    return false;
+                }
+            }
+
+            std::error_code ec;
+            std::filesystem::rename(temp, path, ec);
+            if (ec)
+            {
+                std::filesystem::remove(temp, ec);
+                return false;
+            }
+            return true;
+        }
+    }
+
+    /**
+    The persistent cache of compiled scripts.
+    An entry is keyed by the script path, the hash of its content, the versions of Squeeze and Squirrel,
+    and the sizes of characters, integers and reals, so a change of any of them misses the cache.
+    */
+    class BytecodeCache
+    {
+    private:
+        std::filesystem::path directory_;
+
+    public:
+        /** Construct */
+        BytecodeCache() = default;
+
+        /** Use 'directory' for cache entries. The directory is created if it is not exist. */
+        explicit BytecodeCache(const std::filesystem::path& directory)
+            : directory_(directory)
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(directory_, ec);
+        }
+
+        /** Whether the cache is used or not */
+        bool enabled() const
+        {
+            return !directory_.empty();
+        }
+
+        /** Return the path of the entry for a script and its content. */
+        std::filesystem::path entry(const string_t& path, const std::vector<unsigned char>& source) const
+        {
+            auto h = detail::configHash();
+            h = detail::hash(path.data(), path.length() * sizeof(SQChar), h);
+            h = detail::hash(source.data(), source.size(), h);
+
+            std::string name(16, '0');
+            for (size_t i = 0; i < name.size(); ++i)
+            {
+                name[i] = "0123456789abcdef"[(h >> (60 - i * 4)) & 0xf];
+            }
+            return directory_ / (name + ".cnut");
+        }
+
+        /** Load the closure of an entry and push it. Return false if the entry is not exist or broken. */
+        bool load(HSQUIRRELVM vm, const std::filesystem::path& entry) const
+        {
+            std::vector<unsigned char> bytes;
+            if (!detail::readFile(entry, bytes))
+            {
+                return false;
+            }
+
+            detail::MemoryReader reader{ bytes.data(), bytes.size(), 0 };
+            if (SQ_FAILED(sq_readclosure(vm, detail::MemoryReader::read, &reader)))
+            {
+                sq_reseterror(vm);
+                return false;
+            }
+            return true;
+        }
+
+        /**
+        Write the closure on the top of the stack to an entry.
+        Return false if the entry can not be written.
+        */
+        bool store(HSQUIRRELVM vm, const std::filesystem::path& entry) const
+        {
+            std::vector<unsigned char> bytes;
+            detail::MemoryWriter writer{ &bytes };
+            if (SQ_FAILED(sq_writeclosure(vm, detail::MemoryWriter::write, &writer)))
+            {
+                sq_reseterror(vm);
+                return false;
+            }
+            return detail::writeFile(entry, bytes);
+        }
+    };
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "sqzclosure.h"
 #include "sqztable.h"
 #include "sqztableimpl.h"
+#include "sqzkey.h"
 #include "sqzstackop.h"
 #include "sqzdef.h"
 #include <squirrel.h>
@@ -20,6 +21,9 @@ namespace squeeze
         HTable setTable_;
         HTable getTable_;
 
+        template <class U>
+        friend class HClass;
+
     public:
         /** Construct */
         HClass() = default;
@@ -32,6 +36,7 @@ namespace squeeze
             vm_ = vm;
             const auto top = sq_gettop(vm_);
             sq_newclass(vm_, SQFalse);
+            sq_settypetag(vm_, -1, typeTag<Class>());
             sq_getstackobj(vm_, -1, &obj_);
             sq_addref(vm_, &obj_);
             sq_settop(vm_, top);
@@ -44,10 +49,14 @@ namespace squeeze
             : setTable_(base.setTable_.clone())
             , getTable_(base.getTable_.clone())
         {
+            detail::registerBase<Class, U>();
+
             vm_ = base.vm();
             const auto top = sq_gettop(vm_);
             pushValue(vm_, base);
             sq_newclass(vm_, SQTrue);
+            sq_setclassudsize(vm_, -1, 0); // Do not inherit the inline storage of 'base'.
+            sq_settypetag(vm_, -1, typeTag<Class>());
             sq_getstackobj(vm_, -1, &obj_);
             sq_addref(vm_, &obj_);
             sq_settop(vm_, top);
@@ -58,20 +67,39 @@ namespace squeeze
         template <class... Args>
         HClass& ctor()
         {
-            newClosure(SQZ_T("constructor"), CtorClosure<Class>::ctor<Args...>, false);
+            newClosure(SQZ_T("constructor"), CtorClosure<Class>::ctor<Args...>, CtorClosure<Class>::check<Args...>(), false);
+            return *this;
+        }
+
+        /**
+        Construct instances in the instance memory instead of allocating them on the heap.
+        This must be called before any instance is created.
+        */
+        HClass& inlineStorage()
+        {
+            static_assert(alignof(Class) <= alignof(SQUserPointer), "The class alignment is too large for the inline storage.");
+
+            const auto top = sq_gettop(vm_);
+            pushValue(vm_, obj_);
+            if (SQ_FAILED(sq_setclassudsize(vm_, -1, sizeof(Class))))
+            {
+                sq_settop(vm_, top);
+                failed<ObjectHandlingFailed>(vm_, "sq_setclassudsize() failed.");
+            }
+            sq_settop(vm_, top);
             return *this;
         }
 
         /** Add a member as a variable */
         template <class T>
-        HClass& var(const string_t& name, T&& val, bool isStatic = false)
+        HClass& var(const Key& name, T&& val, bool isStatic = false)
         {
             newSlot(name, std::forward<T>(val), isStatic);
             return *this;
         }
 
         /** Add a member as a table */
-        HClass& table(const string_t& name, HTable table, bool isStatic = false)
+        HClass& table(const Key& name, HTable table, bool isStatic = false)
         {
             newSlot(name, table, isStatic);
             return *this;
@@ -79,48 +107,107 @@ namespace squeeze
 
         /** Add a member as a setter. */
         template <class Setter, class = std::enable_if_t<std::is_same<ReturnType<Setter>, void>::value>>
-        HClass& setter(const string_t& name, const Setter& set)
+        HClass& setter(const Key& name, const Setter& set)
         {
-            setTable_.newClosure(name, Closure::memfun<Setter, Class>, false, UserData(&set, sizeof(Setter)));
+            setTable_.var(name, PropertyAccessor(Closure::setProperty<Setter, Class>, UserData(&set, sizeof(Setter))));
+            return *this;
+        }
+
+        /** Add a member as a setter which is bound at compile time. */
+        template <auto set>
+        HClass& setter(const Key& name)
+        {
+            setTable_.var(name, PropertyAccessor(Closure::fixedSetProperty<set, Class>, UserData(nullptr, 0)));
             return *this;
         }
 
         /** Add a member as a getter. */
         template <class Getter, class = std::enable_if_t<!std::is_same<ReturnType<Getter>, void>::value>>
-        HClass& getter(const string_t& name, const Getter& get)
+        HClass& getter(const Key& name, const Getter& get)
+        {
+            getTable_.var(name, PropertyAccessor(Closure::getProperty<Getter, Class>, UserData(&get, sizeof(Getter))));
+            return *this;
+        }
+
+        /** Add a member as a getter which is bound at compile time. */
+        template <auto get>
+        HClass& getter(const Key& name)
         {
-            getTable_.newClosure(name, Closure::memfun<Getter, Class>, false, UserData(&get, sizeof(Getter)));
+            getTable_.var(name, PropertyAccessor(Closure::fixedGetProperty<get, Class>, UserData(nullptr, 0)));
             return *this;
         }
 
         /** Add a member as a property. */
         template <class Getter, class Setter>
-        HClass& prop(const string_t& name, const Getter& get, const Setter& set)
+        HClass& prop(const Key& name, const Getter& get, const Setter& set)
         {
             getter(name, get);
             setter(name, set);
             return *this;
         }
 
+        /** Add a member as a property which is bound at compile time. */
+        template <auto get, auto set>
+        HClass& prop(const Key& name)
+        {
+            getter<get>(name);
+            setter<set>(name);
+            return *this;
+        }
+
+        /**
+        Add a data member as a property.
+        Accessors are shared by members of the same type and access the member through the member pointer.
+        A const member is read only.
+        */
+        template <class T, class C, class = std::enable_if_t<std::is_base_of<C, Class>::value>>
+        HClass& field(const Key& name, T C::* member)
+        {
+            T Class::* m = member;
+            getTable_.var(name, PropertyAccessor(Closure::getField<T, Class>, UserData(&m, sizeof(m))));
+            if constexpr (!std::is_const<T>::value)
+            {
+                setTable_.var(name, PropertyAccessor(Closure::setField<T, Class>, UserData(&m, sizeof(m))));
+            }
+            return *this;
+        }
+
         /** Add a member as a non-static function */
         template <class F>
-        HClass& fun(const string_t& name, const F& f)
+        HClass& fun(const Key& name, const F& f)
         {
-            newClosure(name, Closure::memfun<F, Class>, false, UserData(&f, sizeof(F)));
+            newMemberFunction<Class>(name, f, false);
+            return *this;
+        }
+
+        /** Add a member as a non-static function which is bound at compile time */
+        template <auto f>
+        HClass& fun(const Key& name)
+        {
+            newClosure(name, Closure::fixedMemfun<f, Class>, Closure::memfunCheck<decltype(f)>(), false);
             return *this;
         }
 
         /** Add a member as a static function */
         template <class F>
-        HClass& staticFun(const string_t& name, const F& f)
+        HClass& staticFun(const Key& name, const F& f)
+        {
+            newFunction(name, f, true);
+            return *this;
+        }
+
+        /** Add a member as a static function which is bound at compile time */
+        template <auto f>
+        HClass& staticFun(const Key& name)
         {
-            newClosure(name, Closure::fun<F>, true, UserData(&f, sizeof(F)));
+            newClosure(name, Closure::fixedFun<f>, Closure::funCheck<decltype(f)>(), true);
             return *this;
         }
 
     private:
         void init()
         {
+            registerClass(vm_, typeTag<Class>(), obj_);
             newClosure(SQZ_T("_set"), Closure::opSet, false, setTable_);
             newClosure(SQZ_T("_get"), Closure::opGet, false, getTable_);
         }
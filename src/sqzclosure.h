@@ -6,17 +6,77 @@
 #include <squirrel.h>
 #include <type_traits>
 #include <tuple>
+#include <new>
+#include <algorithm>
+#include <exception>
+#include <vector>
 
 namespace squeeze
 {
     namespace detail
     {
         struct VoidType {};
+
+        /**
+        Run the body of a native closure.
+        A C++ exception is raised as a Squirrel error, so it never unwinds through the VM.
+        */
+        template <class F>
+        SQInteger guard(HSQUIRRELVM vm, F&& f)
+        {
+            try
+            {
+                return f();
+            }
+            catch (const std::exception& e)
+            {
+                return sq_throwerror(vm, widen(e.what()).c_str());
+            }
+        }
+
+        /** Raise the error of an accessor called on an instance which has no valid object of the bound class. */
+        inline SQInteger invalidInstance(HSQUIRRELVM vm)
+        {
+            return sq_throwerror(vm, SQZ_T("The instance does not refer to a valid object of the bound class."));
+        }
+
+        /** Replace the class object on the top of the stack with a new instance holding 'inst'. */
+        template <class Class>
+        bool newInstance(HSQUIRRELVM vm, SQInteger top, Class&& inst)
+        {
+            if (SQ_FAILED(sq_createinstance(vm, -1)))
+            {
+                sq_settop(vm, top);
+                return false;
+            }
+            sq_remove(vm, -2); // Remove the class object.
+
+            SQUserPointer up;
+            sq_getinstanceup(vm, -1, &up, nullptr);
+            if (up)
+            {
+                new (up) Class(std::move(inst));
+                sq_setreleasehook(vm, -1, CtorClosure<Class>::destructHook);
+                return true;
+            }
+
+            const auto copy = new Class(std::move(inst));
+            if (SQ_FAILED(sq_setinstanceup(vm, -1, copy)))
+            {
+                delete copy;
+                sq_settop(vm, top);
+                return false;
+            }
+            sq_setreleasehook(vm, -1, CtorClosure<Class>::releaseHook);
+
+            return true;
+        }
     }
 
     /**
     Create a class instance object and push it to the stack.
     The class is converted to the object required the move or copy constructor (move has priority).
+    The object is constructed in the instance memory if the class has the inline storage.
     */
     template <class Class>
     bool pushClassInstance(HSQUIRRELVM vm, HSQOBJECT env, const SQChar* classKey, Class&& inst)
@@ -37,27 +97,307 @@ namespace squeeze
                 return false;
             }
         }
+        sq_remove(vm, -2); // Remove the table (roottable or env).
+
+        return detail::newInstance(vm, top, std::move(inst));
+    }
+
+    /** Register a class object as the class of the C++ type which has 'tag'. */
+    inline void registerClass(HSQUIRRELVM vm, SQUserPointer tag, HSQOBJECT clazz)
+    {
+        const auto top = sq_gettop(vm);
+        sq_pushregistrytable(vm);
+        sq_pushuserpointer(vm, tag);
+        sq_pushobject(vm, clazz);
+        if (SQ_FAILED(sq_newslot(vm, -3, SQFalse)))
+        {
+            sq_settop(vm, top);
+            failed<ObjectHandlingFailed>(vm, "sq_newslot() failed.");
+        }
+        sq_settop(vm, top);
+    }
+
+    /** Push the class registered for the C++ type which has 'tag'. */
+    inline bool pushRegisteredClass(HSQUIRRELVM vm, SQUserPointer tag)
+    {
+        const auto top = sq_gettop(vm);
+
+        sq_pushregistrytable(vm);
+        sq_pushuserpointer(vm, tag);
+        if (SQ_FAILED(sq_rawget(vm, -2)))
+        {
+            sq_settop(vm, top);
+            return false;
+        }
+        sq_remove(vm, -2); // Remove the registry table.
+        return true;
+    }
+
+    /**
+    Create an instance of the class registered for the C++ type and push it to the stack.
+    The class is looked up by the type tag, so no class name is needed.
+    */
+    template <class Class>
+    bool pushClassInstance(HSQUIRRELVM vm, Class&& inst)
+    {
+        const auto top = sq_gettop(vm);
+        if (!pushRegisteredClass(vm, typeTag<std::decay_t<Class>>()))
+        {
+            return false;
+        }
+        return detail::newInstance(vm, top, std::move(inst));
+    }
+
+    /**
+    Create an instance of the registered class which refers to an object owned by C++, and push it to the stack.
+    The instance has no release hook unless the reference has a generation counter.
+    */
+    template <class T>
+    bool pushClassRef(HSQUIRRELVM vm, const ClassRef<T>& ref)
+    {
+        const auto top = sq_gettop(vm);
+        if (!pushRegisteredClass(vm, typeTag<std::remove_cv_t<T>>()))
+        {
+            return false;
+        }
         if (SQ_FAILED(sq_createinstance(vm, -1)))
         {
             sq_settop(vm, top);
             return false;
         }
+        sq_remove(vm, -2); // Remove the class object.
+
+        const auto p = const_cast<std::remove_cv_t<T>*>(ref.p);
+        if (!ref.generation)
+        {
+            sq_setinstanceup(vm, -1, p);
+            sq_setreleasehook(vm, -1, detail::releaseNothing);
+            return true;
+        }
+
+        const auto holder = new detail::InstanceHolder;
+        holder->p = p;
+        holder->generation = ref.generation;
+        holder->expected = *ref.generation;
+        sq_setinstanceup(vm, -1, holder);
+        sq_setreleasehook(vm, -1, detail::releaseHolder);
+        return true;
+    }
+
+    namespace detail
+    {
+        inline SQUserPointer sharedInstancesTag()
+        {
+            static char tag;
+            return &tag;
+        }
 
-        sq_remove(vm, -3); // Remove the table (roottable or env).
+        inline SQUserPointer sharedPurgeTag()
+        {
+            static char tag;
+            return &tag;
+        }
+
+        /** Push the table which maps objects shared with C++ to weak references of their instances. */
+        inline void pushSharedInstances(HSQUIRRELVM vm)
+        {
+            sq_pushregistrytable(vm);
+            sq_pushuserpointer(vm, sharedInstancesTag());
+            if (SQ_FAILED(sq_rawget(vm, -2)))
+            {
+                sq_newtable(vm);
+                sq_pushuserpointer(vm, sharedInstancesTag());
+                sq_push(vm, -2);
+                sq_rawset(vm, -4);
+            }
+            sq_remove(vm, -2); // Remove the registry table.
+        }
+
+        /** Return the size of the table of shared instances at which the next purge runs. */
+        inline SQInteger sharedPurgeThreshold(HSQUIRRELVM vm)
+        {
+            const auto top = sq_gettop(vm);
+            SQInteger threshold = 16;
+            sq_pushregistrytable(vm);
+            sq_pushuserpointer(vm, sharedPurgeTag());
+            if (SQ_SUCCEEDED(sq_rawget(vm, -2)))
+            {
+                sq_getinteger(vm, -1, &threshold);
+            }
+            sq_settop(vm, top);
+            return threshold;
+        }
+
+        /**
+        Remove entries of released instances from the table at 'table'.
+        Release hooks have no VM, so dead entries are removed when the table has grown to twice the live entries of the last purge.
+        Each purge is preceded by as many inserts as the entries it scans, so the cost per insert is constant.
+        */
+        inline void purgeSharedInstances(HSQUIRRELVM vm, SQInteger table)
+        {
+            const auto size = sq_getsize(vm, table);
+            if (size < sharedPurgeThreshold(vm))
+            {
+                return;
+            }
+
+            const auto top = sq_gettop(vm);
+            std::vector<SQUserPointer> dead;
+            sq_pushnull(vm);
+            while (SQ_SUCCEEDED(sq_next(vm, table)))
+            {
+                sq_getweakrefval(vm, -1);
+                if (sq_gettype(vm, -1) == OT_NULL)
+                {
+                    SQUserPointer p;
+                    sq_getuserpointer(vm, -3, &p);
+                    dead.push_back(p);
+                }
+                sq_pop(vm, 3);
+            }
+            sq_settop(vm, top);
+
+            for (const auto p : dead)
+            {
+                sq_pushuserpointer(vm, p);
+                sq_deleteslot(vm, table, SQFalse);
+            }
+
+            const auto live = size - static_cast<SQInteger>(dead.size());
+            sq_pushregistrytable(vm);
+            sq_pushuserpointer(vm, sharedPurgeTag());
+            sq_pushinteger(vm, std::max<SQInteger>(16, live * 2));
+            sq_rawset(vm, -3);
+            sq_settop(vm, top);
+        }
+    }
+
+    /**
+    Push an instance of the registered class which shares the object with C++.
+    The instance holds a std::shared_ptr, so the object lives while either side refers to it.
+    If an instance for the same object is alive, it is pushed again instead of creating a new one.
+    */
+    template <class T>
+    bool pushSharedInstance(HSQUIRRELVM vm, const std::shared_ptr<T>& ptr)
+    {
+        using Class = std::remove_cv_t<T>;
+
+        if (!ptr)
+        {
+            sq_pushnull(vm);
+            return true;
+        }
+
+        const auto top = sq_gettop(vm);
+        const auto p = const_cast<Class*>(ptr.get());
+
+        detail::pushSharedInstances(vm);
+        sq_pushuserpointer(vm, p);
+        if (SQ_SUCCEEDED(sq_rawget(vm, top + 1)))
+        {
+            sq_getweakrefval(vm, -1);
+            if (getInstance<Class>(vm, -1) == p)
+            {
+                sq_remove(vm, -2); // Remove the weak reference.
+                sq_remove(vm, -2); // Remove the table.
+                return true;
+            }
+            sq_settop(vm, top + 1);
+        }
+
+        if (!pushRegisteredClass(vm, typeTag<Class>()) || SQ_FAILED(sq_createinstance(vm, -1)))
+        {
+            sq_settop(vm, top);
+            return false;
+        }
         sq_remove(vm, -2); // Remove the class object.
 
-        const auto copy = new Class(std::move(inst));
-        if (SQ_FAILED(sq_setinstanceup(vm, -1, copy)))
+        const auto holder = new detail::InstanceHolder;
+        holder->p = p;
+        holder->owner = std::const_pointer_cast<Class>(ptr);
+        sq_setinstanceup(vm, -1, holder);
+        sq_setreleasehook(vm, -1, detail::releaseHolder);
+
+        sq_pushuserpointer(vm, p);
+        sq_weakref(vm, top + 2);
+        sq_rawset(vm, top + 1);
+        detail::purgeSharedInstances(vm, top + 1);
+        sq_remove(vm, top + 1); // Remove the table.
+        return true;
+    }
+
+    /**
+    Push an instance of the registered class which takes the ownership of the object.
+    With the default deleter the instance adopts the pointer, otherwise the instance holds the std::unique_ptr.
+    */
+    template <class T, class D>
+    bool pushUniqueInstance(HSQUIRRELVM vm, std::unique_ptr<T, D>&& ptr)
+    {
+        using Class = std::remove_cv_t<T>;
+
+        if (!ptr)
+        {
+            sq_pushnull(vm);
+            return true;
+        }
+
+        const auto top = sq_gettop(vm);
+        if (!pushRegisteredClass(vm, typeTag<Class>()) || SQ_FAILED(sq_createinstance(vm, -1)))
         {
-            delete copy;
             sq_settop(vm, top);
             return false;
         }
-        sq_setreleasehook(vm, -1, CtorClosure<Class>::releaseHook);
+        sq_remove(vm, -2); // Remove the class object.
 
+        if constexpr (std::is_same<D, std::default_delete<T>>::value)
+        {
+            sq_setinstanceup(vm, -1, const_cast<Class*>(ptr.release()));
+            sq_setreleasehook(vm, -1, CtorClosure<Class>::releaseHook);
+        }
+        else
+        {
+            const auto holder = new detail::UniqueHolder<T, D>;
+            holder->p = const_cast<Class*>(ptr.get());
+            holder->ptr = std::move(ptr);
+            sq_setinstanceup(vm, -1, static_cast<detail::InstanceHolder*>(holder));
+            sq_setreleasehook(vm, -1, detail::releaseHolder);
+        }
         return true;
     }
 
+    /** Push the values into the stack. */
+    template <class T, class... Ts>
+    void pushValue(HSQUIRRELVM vm, const ClassRef<T>& val, Ts&&... values)
+    {
+        if (!pushClassRef(vm, val))
+        {
+            failed<StackOperationFailed>(vm, "Failed to create instance.");
+        }
+        pushValue(vm, std::forward<Ts>(values)...);
+    }
+
+    /// ditto
+    template <class T, class... Ts>
+    void pushValue(HSQUIRRELVM vm, const std::shared_ptr<T>& val, Ts&&... values)
+    {
+        if (!pushSharedInstance(vm, val))
+        {
+            failed<StackOperationFailed>(vm, "Failed to create instance.");
+        }
+        pushValue(vm, std::forward<Ts>(values)...);
+    }
+
+    /// ditto
+    template <class T, class D, class... Ts>
+    void pushValue(HSQUIRRELVM vm, std::unique_ptr<T, D>&& val, Ts&&... values)
+    {
+        if (!pushUniqueInstance(vm, std::move(val)))
+        {
+            failed<StackOperationFailed>(vm, "Failed to create instance.");
+        }
+        pushValue(vm, std::forward<Ts>(values)...);
+    }
+
     /** Push the return value */
     template <class R>
     auto pushReturn(HSQUIRRELVM vm, R ret)
@@ -69,12 +409,24 @@ namespace squeeze
     /// ditto
     template <class R>
     auto pushReturn(HSQUIRRELVM vm, R ret)
-        -> std::enable_if_t<!std::is_same<R, detail::VoidType>::value, SQInteger>
+        -> std::enable_if_t<!std::is_same<R, detail::VoidType>::value && !IsInstanceValue<R>::value, SQInteger>
     {
         pushValue(vm, ret);
         return 1;
     }
 
+    /// ditto
+    template <class R>
+    auto pushReturn(HSQUIRRELVM vm, R ret)
+        -> std::enable_if_t<!std::is_same<R, detail::VoidType>::value && IsInstanceValue<R>::value, SQInteger>
+    {
+        if (!pushClassInstance(vm, std::move(ret)))
+        {
+            failed<CallFailed>(vm, "Failed to create instance.");
+        }
+        return 1;
+    }
+
     /// ditto
     template <class T>
     SQInteger pushReturn(HSQUIRRELVM vm, ClassConv<T>&& ret)
@@ -92,25 +444,70 @@ namespace squeeze
         return 1;
     }
 
+    /// ditto
+    template <class T>
+    SQInteger pushReturn(HSQUIRRELVM vm, ClassRef<T>&& ret)
+    {
+        if (!pushClassRef(vm, ret))
+        {
+            failed<CallFailed>(vm, "Failed to create instance.");
+        }
+        return 1;
+    }
+
+    /// ditto
+    template <class T>
+    SQInteger pushReturn(HSQUIRRELVM vm, std::shared_ptr<T>&& ret)
+    {
+        if (!pushSharedInstance(vm, ret))
+        {
+            failed<CallFailed>(vm, "Failed to create instance.");
+        }
+        return 1;
+    }
+
+    /// ditto
+    template <class T, class D>
+    SQInteger pushReturn(HSQUIRRELVM vm, std::unique_ptr<T, D>&& ret)
+    {
+        if (!pushUniqueInstance(vm, std::move(ret)))
+        {
+            failed<CallFailed>(vm, "Failed to create instance.");
+        }
+        return 1;
+    }
+
     namespace detail
     {
         template <size_t offset, size_t... I, class F, class... Heads, class R = ReturnType<F>>
         auto fetchImpl(IndexSequence<I...>, HSQUIRRELVM vm, F&& f, Heads&&... heads)
             -> std::enable_if_t<!std::is_same<R, void>::value, R>
         {
-            return call(std::forward<F>(f), std::forward<Heads>(heads)..., getValue<ArgumentType<F, offset + I>>(vm, I + 2)...);
+            return call(std::forward<F>(f), std::forward<Heads>(heads)..., fetchValue<ArgumentType<F, offset + I>>(vm, I + 2)...);
         }
 
         template <size_t offset, size_t... I, class F, class... Heads, class R = ReturnType<F>>
         auto fetchImpl(IndexSequence<I...>, HSQUIRRELVM vm, F&& f, Heads&&... heads)
             -> std::enable_if_t<std::is_same<R, void>::value, VoidType>
         {
-            call(std::forward<F>(f), std::forward<Heads>(heads)..., getValue<ArgumentType<F, offset + I>>(vm, I + 2)...);
+            call(std::forward<F>(f), std::forward<Heads>(heads)..., fetchValue<ArgumentType<F, offset + I>>(vm, I + 2)...);
             return{};
         }
     }
 
-    /** Fetch arguments from the stack and call the function */
+    namespace detail
+    {
+        template <class This, class F, size_t offset, size_t... I>
+        ParamsCheck paramsCheckImpl(IndexSequence<I...>)
+        {
+            return makeParamsCheck<This, ArgumentType<F, offset + I>...>();
+        }
+    }
+
+    /**
+    Fetch arguments from the stack and call the function.
+    Argument types must be checked by the VM with the closure's ParamsCheck.
+    */
     template <class F, size_t arity = FunctionTraits<F>::arity>
     auto fetch(HSQUIRRELVM vm, F&& f)
         -> decltype(detail::fetchImpl<0>(MakeIndices<arity>(), vm, std::forward<F>(f)))
@@ -144,16 +541,40 @@ namespace squeeze
             using ArgTuple = std::tuple<Args...>;
             const auto arity = sizeof...(Args);
 
-            const auto inst = instantiate<ArgTuple>(vm, MakeIndices<arity>());
-            sq_setinstanceup(vm, 1, inst);
-            sq_setreleasehook(vm, 1, releaseHook);
-            return 0;
+            return detail::guard(vm, [&]() -> SQInteger
+            {
+                SQUserPointer up;
+                sq_getinstanceup(vm, 1, &up, nullptr);
+                if (up)
+                {
+                    instantiate<ArgTuple>(vm, up, MakeIndices<arity>());
+                    sq_setreleasehook(vm, 1, destructHook);
+                    return 0;
+                }
+
+                const auto inst = instantiate<ArgTuple>(vm, MakeIndices<arity>());
+                sq_setinstanceup(vm, 1, inst);
+                sq_setreleasehook(vm, 1, releaseHook);
+                return 0;
+            });
         }
 
         template <class Args, size_t... I>
         static Class* instantiate(HSQUIRRELVM vm, IndexSequence<I...>)
         {
-            return new Class(getValue<std::tuple_element_t<I, Args>>(vm, I + 2)...);
+            return new Class(fetchValue<std::tuple_element_t<I, Args>>(vm, I + 2)...);
+        }
+
+        template <class Args, size_t... I>
+        static Class* instantiate(HSQUIRRELVM vm, SQUserPointer up, IndexSequence<I...>)
+        {
+            return new (up) Class(fetchValue<std::tuple_element_t<I, Args>>(vm, I + 2)...);
+        }
+
+        template <class... Args>
+        static ParamsCheck check()
+        {
+            return makeParamsCheck<detail::InstanceMask, Args...>();
         }
 
         static SQInteger releaseHook(SQUserPointer p, SQInteger)
@@ -161,19 +582,40 @@ namespace squeeze
             delete static_cast<Class*>(p);
             return 0;
         }
+
+        static SQInteger destructHook(SQUserPointer p, SQInteger)
+        {
+            static_cast<Class*>(p)->~Class();
+            return 0;
+        }
     };
 
     /** Closures for function embeddings. */
     struct Closure
     {
+        template <class F>
+        static ParamsCheck funCheck()
+        {
+            return detail::paramsCheckImpl<detail::AnyMask, F, 0>(MakeIndices<FunctionTraits<F>::arity>());
+        }
+
+        template <class F, size_t offset = std::is_member_pointer<F>::value ? 0 : 1>
+        static ParamsCheck memfunCheck()
+        {
+            return detail::paramsCheckImpl<detail::InstanceMask, F, offset>(MakeIndices<FunctionTraits<F>::arity - offset>());
+        }
+
         template <class F>
         static SQInteger fun(HSQUIRRELVM vm)
         {
             F* f;
             sq_getuserdata(vm, -1, reinterpret_cast<SQUserPointer*>(&f), nullptr);
 
-            auto&& ret = fetch(vm, *f);
-            return pushReturn(vm, std::move(ret));
+            return detail::guard(vm, [&]
+            {
+                auto&& ret = fetch(vm, *f);
+                return pushReturn(vm, std::move(ret));
+            });
         }
 
         template <class F, class Class>
@@ -182,58 +624,256 @@ namespace squeeze
             F* f;
             sq_getuserdata(vm, -1, reinterpret_cast<SQUserPointer*>(&f), nullptr);
 
-            Class* inst;
-            sq_getinstanceup(vm, 1, reinterpret_cast<SQUserPointer*>(&inst), nullptr);
+            const auto inst = getInstance<Class>(vm, 1);
+            if (!inst)
+            {
+                return detail::invalidInstance(vm);
+            }
 
-            auto&& ret = fetch(vm, *f, inst);
-            return pushReturn(vm, std::move(ret));
+            return detail::guard(vm, [&]
+            {
+                auto&& ret = fetch(vm, *f, inst);
+                return pushReturn(vm, std::move(ret));
+            });
         }
 
-        static SQInteger opSet(HSQUIRRELVM vm)
+        template <auto f>
+        static SQInteger fixedFun(HSQUIRRELVM vm)
         {
-            const auto top = sq_gettop(vm);
+            return detail::guard(vm, [&]
+            {
+                auto&& ret = fetch(vm, f);
+                return pushReturn(vm, std::move(ret));
+            });
+        }
 
-            sq_push(vm, 2);
-            if (SQ_FAILED(sq_get(vm, -2)))
+        template <auto f, class Class>
+        static SQInteger fixedMemfun(HSQUIRRELVM vm)
+        {
+            const auto inst = getInstance<Class>(vm, 1);
+            if (!inst)
             {
-                sq_settop(vm, top);
-                failed<CallFailed>(vm, "sq_get() failed.");
+                return detail::invalidInstance(vm);
             }
 
-            sq_push(vm, 1);
-            sq_push(vm, 3);
+            return detail::guard(vm, [&]
+            {
+                auto&& ret = fetch(vm, f, inst);
+                return pushReturn(vm, std::move(ret));
+            });
+        }
+
+        /** The instance of a stateless callable. The first call must pass the instance. */
+        template <class F>
+        static const F& stateless(const F* f = nullptr)
+        {
+            static const F instance = *f;
+            return instance;
+        }
 
-            if (sq_call(vm, 2, SQFalse, SQTrue))
+        template <class F>
+        static SQInteger statelessFun(HSQUIRRELVM vm)
+        {
+            return detail::guard(vm, [&]
             {
-                sq_settop(vm, top);
-                failed<CallFailed>(vm, "sq_call() failed.");
+                auto&& ret = fetch(vm, stateless<F>());
+                return pushReturn(vm, std::move(ret));
+            });
+        }
+
+        template <class F, class Class>
+        static SQInteger statelessMemfun(HSQUIRRELVM vm)
+        {
+            const auto inst = getInstance<Class>(vm, 1);
+            if (!inst)
+            {
+                return detail::invalidInstance(vm);
             }
-            sq_settop(vm, top);
-            return 0;
+
+            return detail::guard(vm, [&]
+            {
+                auto&& ret = fetch(vm, stateless<F>(), inst);
+                return pushReturn(vm, std::move(ret));
+            });
         }
 
-        static SQInteger opGet(HSQUIRRELVM vm)
+        template <class F, class Class>
+        static SQInteger getProperty(HSQUIRRELVM vm, const void* f)
+        {
+            const auto inst = getInstance<Class>(vm, 1);
+            if (!inst)
+            {
+                return detail::invalidInstance(vm);
+            }
+
+            return detail::guard(vm, [&]
+            {
+                auto&& ret = fetch(vm, *static_cast<const F*>(f), inst);
+                return pushReturn(vm, std::move(ret));
+            });
+        }
+
+        template <auto get, class Class>
+        static SQInteger fixedGetProperty(HSQUIRRELVM vm, const void*)
+        {
+            const auto inst = getInstance<Class>(vm, 1);
+            if (!inst)
+            {
+                return detail::invalidInstance(vm);
+            }
+
+            return detail::guard(vm, [&]
+            {
+                auto&& ret = fetch(vm, get, inst);
+                return pushReturn(vm, std::move(ret));
+            });
+        }
+
+        template <class F, class Class, size_t offset = std::is_member_pointer<F>::value ? 0 : 1>
+        static SQInteger setProperty(HSQUIRRELVM vm, const void* f)
+        {
+            const auto inst = getInstance<Class>(vm, 1);
+            if (!inst)
+            {
+                return detail::invalidInstance(vm);
+            }
+
+            // The value is not checked by the VM, so a mismatch is raised as a Squirrel error.
+            return detail::guard(vm, [&]() -> SQInteger
+            {
+                call(*static_cast<const F*>(f), inst, getValue<std::decay_t<ArgumentType<F, offset>>>(vm, 3));
+                return 0;
+            });
+        }
+
+        template <auto set, class Class, size_t offset = std::is_member_pointer<decltype(set)>::value ? 0 : 1>
+        static SQInteger fixedSetProperty(HSQUIRRELVM vm, const void*)
+        {
+            const auto inst = getInstance<Class>(vm, 1);
+            if (!inst)
+            {
+                return detail::invalidInstance(vm);
+            }
+
+            // The value is not checked by the VM, so a mismatch is raised as a Squirrel error.
+            return detail::guard(vm, [&]() -> SQInteger
+            {
+                call(set, inst, getValue<std::decay_t<ArgumentType<decltype(set), offset>>>(vm, 3));
+                return 0;
+            });
+        }
+
+        template <class T, class Class>
+        static SQInteger getField(HSQUIRRELVM vm, const void* member)
+        {
+            const auto inst = getInstance<Class>(vm, 1);
+            if (!inst)
+            {
+                return detail::invalidInstance(vm);
+            }
+
+            return detail::guard(vm, [&]() -> SQInteger
+            {
+                pushValue(vm, inst->**static_cast<T Class::* const*>(member));
+                return 1;
+            });
+        }
+
+        template <class T, class Class>
+        static SQInteger setField(HSQUIRRELVM vm, const void* member)
+        {
+            const auto inst = getInstance<Class>(vm, 1);
+            if (!inst)
+            {
+                return detail::invalidInstance(vm);
+            }
+
+            // The value is not checked by the VM, so a mismatch is raised as a Squirrel error.
+            return detail::guard(vm, [&]() -> SQInteger
+            {
+                inst->**static_cast<T Class::* const*>(member) = getValue<T>(vm, 3);
+                return 0;
+            });
+        }
+
+        /** The _set metamethod which dispatches to a property accessor directly. */
+        static SQInteger opSet(HSQUIRRELVM vm)
         {
             const auto top = sq_gettop(vm);
 
             sq_push(vm, 2);
-            if (SQ_FAILED(sq_get(vm, -2)))
+            if (SQ_FAILED(sq_rawget(vm, -2)))
             {
                 sq_settop(vm, top);
-                failed<CallFailed>(vm, "sq_get() failed.");
+                return sq_throwerror(vm, SQZ_T("The property is not found."));
             }
 
-            sq_push(vm, 1);
+            SQUserPointer accessor;
+            sq_getuserdata(vm, -1, &accessor, nullptr);
+            const auto result = PropertyAccessor::invoke(vm, accessor);
+            sq_settop(vm, top);
+            return SQ_FAILED(result) ? result : 0;
+        }
+
+        /** The _get metamethod which dispatches to a property accessor directly. */
+        static SQInteger opGet(HSQUIRRELVM vm)
+        {
+            const auto top = sq_gettop(vm);
 
-            if (sq_call(vm, 1, SQTrue, SQTrue))
+            sq_push(vm, 2);
+            if (SQ_FAILED(sq_rawget(vm, -2)))
             {
                 sq_settop(vm, top);
-                failed<CallFailed>(vm, "sq_call() failed.");
+                return sq_throwerror(vm, SQZ_T("The property is not found."));
             }
-            sq_remove(vm, -2);
-            return 1;
+
+            SQUserPointer accessor;
+            sq_getuserdata(vm, -1, &accessor, nullptr);
+            return PropertyAccessor::invoke(vm, accessor);
         }
     };
+
+    /**
+    Push a closure which parameters are checked by the VM.
+    Return false if the parameter check is invalid.
+    */
+    template <class... FreeVars>
+    bool pushClosure(HSQUIRRELVM vm, SQFUNCTION closure, const ParamsCheck& check, FreeVars&&... freeVars)
+    {
+        pushValue(vm, std::forward<FreeVars>(freeVars)...);
+        sq_newclosure(vm, closure, sizeof...(FreeVars));
+        return !check.typemask || SQ_SUCCEEDED(sq_setparamscheck(vm, check.nparams, check.typemask));
+    }
+
+    /** Push a closure which calls a function. Stateless functions are bound without free variables. */
+    template <class F>
+    bool pushFunction(HSQUIRRELVM vm, const F& f)
+    {
+        if constexpr (IsStateless<F>::value)
+        {
+            Closure::stateless(&f);
+            return pushClosure(vm, Closure::statelessFun<F>, Closure::funCheck<F>());
+        }
+        else
+        {
+            return pushClosure(vm, Closure::fun<F>, Closure::funCheck<F>(), UserData(&f, sizeof(F)));
+        }
+    }
+
+    /** Push a closure which calls a member function. Stateless functions are bound without free variables. */
+    template <class Class, class F>
+    bool pushMemberFunction(HSQUIRRELVM vm, const F& f)
+    {
+        if constexpr (IsStateless<F>::value)
+        {
+            Closure::stateless(&f);
+            return pushClosure(vm, Closure::statelessMemfun<F, Class>, Closure::memfunCheck<F>());
+        }
+        else
+        {
+            return pushClosure(vm, Closure::memfun<F, Class>, Closure::memfunCheck<F>(), UserData(&f, sizeof(F)));
+        }
+    }
 }
 
 #endif
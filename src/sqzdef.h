@@ -3,8 +3,19 @@
 
 #include <squirrel.h>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <utility>
 #include <tuple>
 #include <type_traits>
+#include <cstdint>
+#include <memory>
+
+/** The version of Squeeze. A change invalidates compiled scripts which are cached. */
+#define SQUEEZE_VERSION_NUMBER 100
 
 /** Replace a string literal to the used character set. */
 #define SQZ_T(s) _SC(s)
@@ -14,6 +25,9 @@ namespace squeeze
     /** The string type */
     using string_t = std::basic_string<SQChar>;
 
+    /** The string view type */
+    using string_view_t = std::basic_string_view<SQChar>;
+
     /** Object types */
     enum class ObjectType
     {
@@ -23,6 +37,8 @@ namespace squeeze
         Bool = OT_BOOL,
         String = OT_STRING,
         Table = OT_TABLE,
+        Array = OT_ARRAY,
+        UserData = OT_USERDATA,
         Class = OT_CLASS,
 
         /// function defined in Squirrel
@@ -64,6 +80,13 @@ namespace squeeze
             : std::runtime_error(msg) {}
     };
 
+    /** The parameter check of closures which is passed to sq_setparamscheck() */
+    struct ParamsCheck
+    {
+        SQInteger nparams;
+        const SQChar* typemask;
+    };
+
     /** The class converter */
     template <class T>
     struct ClassConv
@@ -72,6 +95,239 @@ namespace squeeze
         string_t classKey;
     };
 
+    /**
+    The borrowed reference to an object owned by C++.
+    The instance refers to the object without copying it, and never deletes it.
+    If 'generation' is given, the reference becomes stale when the counter is changed,
+    and a stale reference raises a script error instead of accessing the object.
+    */
+    template <class T>
+    struct ClassRef
+    {
+        T* p;
+        const std::uint32_t* generation = nullptr;
+    };
+
+    /**
+    Return the length of a string in a character array.
+    The length is bounded by the array, so a buffer which holds a shorter string is measured correctly.
+    */
+    template <size_t N>
+    constexpr SQInteger stringLength(const SQChar(&s)[N])
+    {
+        size_t n = 0;
+        while (n < N && s[n] != SQChar())
+        {
+            ++n;
+        }
+        return static_cast<SQInteger>(n);
+    }
+
+    /**
+    The field description of a reflected struct.
+    The name length is given at compile time.
+    */
+    template <class C, class M>
+    struct Field
+    {
+        const SQChar* name;
+        SQInteger length;
+        M C::* member;
+    };
+
+    /** Describe a field of a reflected struct. */
+    template <class C, class M, size_t N>
+    constexpr Field<C, M> makeField(const SQChar(&name)[N], M C::* member)
+    {
+        return{ name, stringLength(name), member };
+    }
+
+    /**
+    The compile-time reflection of a struct, which is converted to a table and from a table.
+    Specialize it with a static constexpr tuple of fields, for example:
+    template <> struct Reflect<Config> { static constexpr auto fields = std::make_tuple(makeField(SQZ_T("width"), &Config::width)); };
+    */
+    template <class T>
+    struct Reflect;
+
+    /** Element types of numeric buffers */
+    enum class BufferType
+    {
+        Float32,
+        Float64,
+        Int32,
+        UInt8,
+    };
+
+    namespace detail
+    {
+        template <class T>
+        struct BufferTypeOfImpl
+        {
+            static constexpr bool supported = false;
+        };
+
+        template <>
+        struct BufferTypeOfImpl<float> : std::integral_constant<BufferType, BufferType::Float32> { static constexpr bool supported = true; };
+
+        template <>
+        struct BufferTypeOfImpl<double> : std::integral_constant<BufferType, BufferType::Float64> { static constexpr bool supported = true; };
+
+        template <>
+        struct BufferTypeOfImpl<std::int32_t> : std::integral_constant<BufferType, BufferType::Int32> { static constexpr bool supported = true; };
+
+        template <>
+        struct BufferTypeOfImpl<std::uint8_t> : std::integral_constant<BufferType, BufferType::UInt8> { static constexpr bool supported = true; };
+    }
+
+    /** The element type of a numeric buffer which elements are T. */
+    template <class T>
+    using BufferTypeOf = detail::BufferTypeOfImpl<std::remove_cv_t<T>>;
+
+    /**
+    The typed view of a contiguous numeric buffer owned by C++.
+    Scripts index the buffer like an array without copying the elements.
+    If 'pin' is given, scripts share it, so the buffer is not freed while a script holds it.
+    A view of const elements is read-only in scripts.
+    */
+    template <class T>
+    struct BufferRef
+    {
+        static_assert(BufferTypeOf<T>::supported, "The element type must be float, double, int32_t or uint8_t.");
+
+        T* data;
+        size_t size;
+        std::shared_ptr<void> pin;
+
+        /** Construct */
+        BufferRef(T* data_, size_t size_, std::shared_ptr<void> pin_ = nullptr)
+            : data(data_), size(size_), pin(std::move(pin_)) {}
+
+        /** Refer to a shared contiguous container, and pin it. */
+        template <class C, class = decltype(std::declval<C&>().data())>
+        BufferRef(const std::shared_ptr<C>& c)
+            : data(c->data()), size(c->size()), pin(c) {}
+
+        T* begin() const { return data; }
+        T* end() const { return data + size; }
+    };
+
+    /**
+    The view of a contiguous sequence which is not owned.
+    The sequence is pushed as an array by copying the elements.
+    */
+    template <class T>
+    struct Span
+    {
+        T* ptr;
+        size_t length;
+
+        /** Construct */
+        Span(T* ptr_, size_t length_) : ptr(ptr_), length(length_) {}
+
+        /** Refer to a contiguous container */
+        template <class C, class = decltype(std::declval<C&>().data())>
+        Span(C& c) : ptr(c.data()), length(c.size()) {}
+
+        T* data() const { return ptr; }
+        size_t size() const { return length; }
+        T* begin() const { return ptr; }
+        T* end() const { return ptr + length; }
+    };
+
+    namespace detail
+    {
+        template <class T>
+        struct IsVectorImpl : std::false_type {};
+
+        template <class T, class A>
+        struct IsVectorImpl<std::vector<T, A>> : std::true_type {};
+
+        template <class T>
+        struct IsPairVectorImpl : std::false_type {};
+
+        template <class K, class V, class A>
+        struct IsPairVectorImpl<std::vector<std::pair<K, V>, A>> : std::true_type {};
+
+        template <class T>
+        struct IsMapImpl : std::false_type {};
+
+        template <class K, class V, class C, class A>
+        struct IsMapImpl<std::map<K, V, C, A>> : std::true_type {};
+
+        template <class K, class V, class H, class E, class A>
+        struct IsMapImpl<std::unordered_map<K, V, H, E, A>> : std::true_type {};
+
+        template <class T>
+        struct IsStdArrayImpl : std::false_type {};
+
+        template <class T, size_t N>
+        struct IsStdArrayImpl<std::array<T, N>> : std::true_type {};
+
+        template <class T>
+        struct IsSpanImpl : std::false_type {};
+
+        template <class T>
+        struct IsSpanImpl<Span<T>> : std::true_type {};
+
+        template <class T>
+        struct IsBufferRefImpl : std::false_type {};
+
+        template <class T>
+        struct IsBufferRefImpl<BufferRef<T>> : std::true_type {};
+
+        template <class T, class = void>
+        struct IsReflectedImpl : std::false_type {};
+
+        template <class T>
+        struct IsReflectedImpl<T, std::void_t<decltype(Reflect<T>::fields)>> : std::true_type {};
+
+        template <class T>
+        struct IsSharedPointerImpl : std::false_type {};
+
+        template <class T>
+        struct IsSharedPointerImpl<std::shared_ptr<T>> : std::true_type {};
+
+        template <class T>
+        struct IsUniquePointerImpl : std::false_type {};
+
+        template <class T, class D>
+        struct IsUniquePointerImpl<std::unique_ptr<T, D>> : std::true_type {};
+    }
+
+    /** Whether T is a associative container which is converted to a table or not. Vectors of pairs are regarded as associative. */
+    template <class T, class X = std::remove_cv_t<std::remove_reference_t<T>>>
+    using IsAssociative = std::integral_constant<bool, detail::IsMapImpl<X>::value || detail::IsPairVectorImpl<X>::value>;
+
+    /** Whether T is a std::vector which is converted to an array or not. */
+    template <class T, class X = std::remove_cv_t<std::remove_reference_t<T>>>
+    using IsVector = std::integral_constant<bool, detail::IsVectorImpl<X>::value && !detail::IsPairVectorImpl<X>::value>;
+
+    /** Whether T is a std::array or not. */
+    template <class T>
+    using IsStdArray = detail::IsStdArrayImpl<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+    /** Whether T is a sequence which is converted to an array or not. */
+    template <class T>
+    using IsSequence = std::integral_constant<bool, IsVector<T>::value || IsStdArray<T>::value ||
+        detail::IsSpanImpl<std::remove_cv_t<std::remove_reference_t<T>>>::value>;
+
+    /** Whether T is a BufferRef or not. */
+    template <class T>
+    using IsBufferRef = detail::IsBufferRefImpl<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+    /** Whether T is a struct which has the reflection or not. */
+    template <class T>
+    using IsReflected = detail::IsReflectedImpl<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+    /** Whether T is a std::shared_ptr or not. */
+    template <class T>
+    using IsSharedPointer = detail::IsSharedPointerImpl<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+    /** Whether T is a std::unique_ptr or not. */
+    template <class T>
+    using IsUniquePointer = detail::IsUniquePointerImpl<std::remove_cv_t<std::remove_reference_t<T>>>;
+
     /** Defined as U type if T is a integer type. */
     template <class T, class U = void, class X = std::remove_cv_t<std::remove_reference_t<T>>>
     using EnableInteger = std::enable_if_t<std::is_integral<X>::value && !std::is_same<X, bool>::value, U>;
@@ -91,6 +347,48 @@ namespace squeeze
     /** Defined as U type if T is a string type. */
     template <class T, class U = void, class X = std::remove_cv_t<std::remove_reference_t<T>>>
     using EnableString = std::enable_if_t<std::is_same<X, string_t>::value, U>;
+
+    /** Defined as U type if T is a pointer to a class type. */
+    template <class T, class U = void, class X = std::remove_cv_t<std::remove_pointer_t<T>>>
+    using EnableInstancePointer = std::enable_if_t<std::is_pointer<T>::value && std::is_class<X>::value, U>;
+
+    /** Defined as U type if T is a reference to a class type except string types. */
+    template <class T, class U = void, class X = std::remove_cv_t<std::remove_reference_t<T>>>
+    using EnableInstanceReference = std::enable_if_t<std::is_lvalue_reference<T>::value && std::is_class<X>::value &&
+        !std::is_same<X, string_t>::value && !std::is_same<X, string_view_t>::value &&
+        !IsSharedPointer<X>::value && !IsUniquePointer<X>::value && !IsSequence<X>::value && !IsBufferRef<X>::value &&
+        !IsAssociative<X>::value && !IsReflected<X>::value, U>;
+
+    /** Defined as U type if T is a reflected struct. */
+    template <class T, class U = void>
+    using EnableReflected = std::enable_if_t<IsReflected<T>::value, U>;
+
+    /** Defined as U type if T is an associative container. */
+    template <class T, class U = void>
+    using EnableAssociative = std::enable_if_t<IsAssociative<T>::value, U>;
+
+    /** Defined as U type if T is a BufferRef. */
+    template <class T, class U = void>
+    using EnableBufferRef = std::enable_if_t<IsBufferRef<T>::value, U>;
+
+    /** Defined as U type if T is a sequence. */
+    template <class T, class U = void>
+    using EnableSequence = std::enable_if_t<IsSequence<T>::value, U>;
+
+    /** Defined as U type if T is a std::shared_ptr. */
+    template <class T, class U = void>
+    using EnableSharedPointer = std::enable_if_t<IsSharedPointer<T>::value, U>;
+
+    /** Whether T is a class type which is pushed as an instance of the registered class or not. */
+    template <class T, class X = std::remove_cv_t<std::remove_reference_t<T>>>
+    using IsInstanceValue = std::integral_constant<bool, std::is_class<X>::value && !std::is_convertible<X, HSQOBJECT>::value &&
+        !std::is_same<X, string_t>::value && !std::is_same<X, string_view_t>::value &&
+        !IsSharedPointer<X>::value && !IsUniquePointer<X>::value && !IsSequence<X>::value && !IsBufferRef<X>::value &&
+        !IsAssociative<X>::value && !IsReflected<X>::value>;
+
+    /** Defined as U type if T is a string view type. */
+    template <class T, class U = void, class X = std::remove_cv_t<std::remove_reference_t<T>>>
+    using EnableStringView = std::enable_if_t<std::is_same<X, string_view_t>::value, U>;
 }
 
 #endif
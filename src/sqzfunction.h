@@ -0,0 +1,91 @@
+#ifndef SQUEEZE_SQZFUNCTION_H
+#define SQUEEZE_SQZFUNCTION_H
+
+#include "sqztable.h"
+#include "sqzkey.h"
+#include "sqzobject.h"
+#include "sqzstackop.h"
+#include "sqzdef.h"
+#include "sqzutil.h"
+#include <squirrel.h>
+#include <type_traits>
+
+namespace squeeze
+{
+    /**
+    The Function object handle.
+    The function is resolved once on construction, so a call pushes only the closure and arguments.
+    */
+    class HFunction : public HObject
+    {
+    public:
+        /** Construct */
+        HFunction() = default;
+
+        /** Create with copy the object handle */
+        HFunction(HVM vm, HSQOBJECT obj)
+        {
+            vm_ = vm;
+            obj_ = obj;
+            sq_addref(vm_, &obj_);
+        }
+
+        /** Resolve a function mapped by 'key' in 'table'. */
+        HFunction(HTable table, const Key& key)
+        {
+            vm_ = table.vm();
+            const auto top = sq_gettop(vm_);
+            pushValue(vm_, table, key);
+            if (SQ_FAILED(sq_get(vm_, -2)))
+            {
+                sq_settop(vm_, top);
+                failed<ObjectHandlingFailed>(vm_, "sq_get() failed.");
+            }
+
+            const auto type = sq_gettype(vm_, -1);
+            if (type != OT_CLOSURE && type != OT_NATIVECLOSURE)
+            {
+                sq_settop(vm_, top);
+                throw ObjectHandlingFailed("The object is not a function.");
+            }
+
+            sq_getstackobj(vm_, -1, &obj_);
+            sq_addref(vm_, &obj_);
+            sq_settop(vm_, top);
+        }
+
+        /** Call the handled function. */
+        template <class Return, class... Args>
+        auto call(HSQOBJECT env, Args&&... args)
+            -> std::enable_if_t<std::is_void<Return>::value, void>
+        {
+            const auto top = sq_gettop(vm_);
+            pushValue(vm_, obj_, env, std::forward<Args>(args)...);
+            if (SQ_FAILED(sq_call(vm_, sizeof...(Args)+1, SQFalse, SQTrue)))
+            {
+                sq_settop(vm_, top);
+                failed<CallFailed>(vm_, "sq_call() failed.");
+            }
+            sq_settop(vm_, top);
+        }
+
+        /// ditto
+        template <class Return, class... Args>
+        auto call(HSQOBJECT env, Args&&... args)
+            -> std::enable_if_t<!std::is_void<Return>::value, Return>
+        {
+            const auto top = sq_gettop(vm_);
+            pushValue(vm_, obj_, env, std::forward<Args>(args)...);
+            if (SQ_FAILED(sq_call(vm_, sizeof...(Args)+1, SQTrue, SQTrue)))
+            {
+                sq_settop(vm_, top);
+                failed<CallFailed>(vm_, "sq_call() failed.");
+            }
+            const auto ret = getValue<Return>(vm_, -1);
+            sq_settop(vm_, top);
+            return ret;
+        }
+    };
+}
+
+#endif
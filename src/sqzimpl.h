@@ -3,6 +3,7 @@
 
 #include "sqztable.h"
 #include "sqzclass.h"
+#include "sqzkernel.h"
 #include "sqzdef.h"
 #include <squirrel.h>
 
@@ -17,13 +18,20 @@ namespace squeeze
         return HTable(*this, root);
     }
     
+    inline void HVM::kernellib()
+    {
+        sq_pushroottable(vm_);
+        detail::registerKernelLib(vm_);
+        sq_poptop(vm_);
+    }
+
     inline void HVM::setRootTable(HTable root)
     {
         sq_pushobject(vm_, root);
         sq_setroottable(vm_);
     }
 
-    template <class Class> HTable& HTable::clazz(const string_t& key, HClass<Class> c)
+    template <class Class> HTable& HTable::clazz(const Key& key, HClass<Class> c)
     {
         newSlot(key, c, false);
         return *this;
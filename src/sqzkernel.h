@@ -0,0 +1,895 @@
+#ifndef SQUEEZE_SQZKERNEL_H
+#define SQUEEZE_SQZKERNEL_H
+
+#include "sqzbuffer.h"
+#include "sqzstackop.h"
+#include "sqzdef.h"
+#include "sqzutil.h"
+#include <squirrel.h>
+#include <sqstdblob.h>
+#include <type_traits>
+#include <algorithm>
+#include <utility>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+/**
+On x86-64, kernels of float and double elements have AVX2 versions, which are selected at run time if the CPU supports AVX2 and FMA.
+Define SQZ_NO_SIMD to use the scalar kernels always.
+*/
+#if (defined(_M_X64) || defined(__x86_64__)) && !defined(SQZ_NO_SIMD)
+#define SQZ_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SQZ_AVX2_TARGET
+#else
+#define SQZ_AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+#else
+#define SQZ_AVX2_TARGET
+#endif
+
+namespace squeeze
+{
+    /** Element-wise operations and reductions over contiguous numeric ranges */
+    namespace kernel
+    {
+        /** The accumulator type of reductions */
+        template <class T>
+        using Accum = std::conditional_t<std::is_floating_point<T>::value, double, std::int64_t>;
+
+        /** Whether the CPU supports the vector kernels */
+        inline bool simdSupported()
+        {
+#if defined(SQZ_AVX2) && defined(_MSC_VER)
+            static const bool supported = []
+            {
+                int info[4];
+                __cpuid(info, 0);
+                if (info[0] < 7)
+                {
+                    return false;
+                }
+                __cpuid(info, 1);
+                const bool fma = (info[2] & (1 << 12)) != 0;
+                const bool osxsave = (info[2] & (1 << 27)) != 0;
+                if (!fma || !osxsave || (_xgetbv(0) & 6) != 6)
+                {
+                    return false;
+                }
+                __cpuidex(info, 7, 0);
+                return (info[1] & (1 << 5)) != 0;
+            }();
+            return supported;
+#elif defined(SQZ_AVX2)
+            static const bool supported = []
+            {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+            }();
+            return supported;
+#else
+            return false;
+#endif
+        }
+
+        namespace detail
+        {
+            inline std::atomic<bool>& simdSwitch()
+            {
+                static std::atomic<bool> enabled(simdSupported());
+                return enabled;
+            }
+        }
+
+        /** Whether the vector kernels are used */
+        inline bool simdEnabled()
+        {
+            return detail::simdSwitch().load(std::memory_order_relaxed);
+        }
+
+        /** Use the vector kernels or not, and return the previous setting. They are never used if the CPU does not support them. */
+        inline bool useSimd(bool use)
+        {
+            return detail::simdSwitch().exchange(use && simdSupported());
+        }
+
+        /** The vector operations of an element type. Types which have no vector operations are processed by scalar loops. */
+        template <class T>
+        struct Simd
+        {
+            static constexpr bool enabled = false;
+        };
+
+#ifdef SQZ_AVX2
+        template <>
+        struct Simd<float>
+        {
+            static constexpr bool enabled = true;
+            static constexpr size_t width = 8;
+            using V = __m256;
+            using Acc = __m256d;
+
+            SQZ_AVX2_TARGET static V load(const float* p) { return _mm256_loadu_ps(p); }
+            SQZ_AVX2_TARGET static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+            SQZ_AVX2_TARGET static V set1(float x) { return _mm256_set1_ps(x); }
+            SQZ_AVX2_TARGET static V add(V a, V b) { return _mm256_add_ps(a, b); }
+            SQZ_AVX2_TARGET static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+            SQZ_AVX2_TARGET static V min(V a, V b) { return _mm256_min_ps(a, b); }
+            SQZ_AVX2_TARGET static V max(V a, V b) { return _mm256_max_ps(a, b); }
+            SQZ_AVX2_TARGET static V fmadd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+
+            SQZ_AVX2_TARGET static Acc zero() { return _mm256_setzero_pd(); }
+            SQZ_AVX2_TARGET static void storeAcc(double* p, Acc v) { _mm256_storeu_pd(p, v); }
+
+            // Elements are widened to double, so partial sums are the same as the scalar kernels.
+            SQZ_AVX2_TARGET static void sumStep(Acc* acc, const float* p)
+            {
+                const auto x = load(p);
+                acc[0] = _mm256_add_pd(acc[0], _mm256_cvtps_pd(_mm256_castps256_ps128(x)));
+                acc[1] = _mm256_add_pd(acc[1], _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)));
+            }
+
+            SQZ_AVX2_TARGET static void dotStep(Acc* acc, const float* a, const float* b)
+            {
+                const auto x = load(a);
+                const auto y = load(b);
+                acc[0] = _mm256_add_pd(acc[0], _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(x)), _mm256_cvtps_pd(_mm256_castps256_ps128(y))));
+                acc[1] = _mm256_add_pd(acc[1], _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)), _mm256_cvtps_pd(_mm256_extractf128_ps(y, 1))));
+            }
+
+            SQZ_AVX2_TARGET static float hmin(V v)
+            {
+                alignas(32) float lanes[width];
+                _mm256_store_ps(lanes, v);
+                return *std::min_element(lanes, lanes + width);
+            }
+
+            SQZ_AVX2_TARGET static float hmax(V v)
+            {
+                alignas(32) float lanes[width];
+                _mm256_store_ps(lanes, v);
+                return *std::max_element(lanes, lanes + width);
+            }
+        };
+
+        template <>
+        struct Simd<double>
+        {
+            static constexpr bool enabled = true;
+            static constexpr size_t width = 4;
+            using V = __m256d;
+            using Acc = __m256d;
+
+            SQZ_AVX2_TARGET static V load(const double* p) { return _mm256_loadu_pd(p); }
+            SQZ_AVX2_TARGET static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+            SQZ_AVX2_TARGET static V set1(double x) { return _mm256_set1_pd(x); }
+            SQZ_AVX2_TARGET static V add(V a, V b) { return _mm256_add_pd(a, b); }
+            SQZ_AVX2_TARGET static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+            SQZ_AVX2_TARGET static V min(V a, V b) { return _mm256_min_pd(a, b); }
+            SQZ_AVX2_TARGET static V max(V a, V b) { return _mm256_max_pd(a, b); }
+            SQZ_AVX2_TARGET static V fmadd(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }
+
+            SQZ_AVX2_TARGET static Acc zero() { return _mm256_setzero_pd(); }
+            SQZ_AVX2_TARGET static void storeAcc(double* p, Acc v) { _mm256_storeu_pd(p, v); }
+
+            // Products are not fused, so partial sums are the same as the scalar kernels.
+            SQZ_AVX2_TARGET static void sumStep(Acc* acc, const double* p)
+            {
+                acc[0] = _mm256_add_pd(acc[0], load(p));
+            }
+
+            SQZ_AVX2_TARGET static void dotStep(Acc* acc, const double* a, const double* b)
+            {
+                acc[0] = _mm256_add_pd(acc[0], _mm256_mul_pd(load(a), load(b)));
+            }
+
+            SQZ_AVX2_TARGET static double hmin(V v)
+            {
+                alignas(32) double lanes[width];
+                _mm256_store_pd(lanes, v);
+                return *std::min_element(lanes, lanes + width);
+            }
+
+            SQZ_AVX2_TARGET static double hmax(V v)
+            {
+                alignas(32) double lanes[width];
+                _mm256_store_pd(lanes, v);
+                return *std::max_element(lanes, lanes + width);
+            }
+        };
+#endif
+
+        namespace detail
+        {
+            /** The number of partial sums of a floating point reduction, which is the vector width */
+            template <class T>
+            constexpr size_t lanes = sizeof(T) == sizeof(float) ? 8 : 4;
+
+            /**
+            Combine partial sums in a fixed order.
+            Both kernels add each element into the same partial sum, so a reduction does not depend on the kernel used.
+            */
+            template <size_t L>
+            double combine(double (&partial)[L])
+            {
+                for (size_t w = L / 2; w >= 4; w /= 2)
+                {
+                    for (size_t l = 0; l < w; ++l)
+                    {
+                        partial[l] += partial[l + w];
+                    }
+                }
+                return (partial[0] + partial[2]) + (partial[1] + partial[3]);
+            }
+        }
+
+        /** The kernels which process elements one by one */
+        namespace scalar
+        {
+            template <class T>
+            void add(T* dst, const T* src, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    dst[i] = static_cast<T>(dst[i] + src[i]);
+                }
+            }
+
+            template <class T>
+            void mul(T* dst, const T* src, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    dst[i] = static_cast<T>(dst[i] * src[i]);
+                }
+            }
+
+            template <class T>
+            void fma(T* dst, const T* a, const T* b, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    dst[i] = static_cast<T>(dst[i] + a[i] * b[i]);
+                }
+            }
+
+            template <class T>
+            void scale(T* dst, T k, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    dst[i] = static_cast<T>(dst[i] * k);
+                }
+            }
+
+            template <class T>
+            void clamp(T* dst, T lo, T hi, size_t n)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    dst[i] = std::min(std::max(dst[i], lo), hi);
+                }
+            }
+
+            /** Sum terms of indices into partial sums of floating point reductions */
+            template <class T, class Term>
+            Accum<T> reduce(size_t n, Term&& term)
+            {
+                if constexpr (std::is_floating_point<T>::value)
+                {
+                    constexpr auto L = detail::lanes<T>;
+                    double partial[L] = {};
+                    size_t i = 0;
+                    for (; i + L <= n; i += L)
+                    {
+                        for (size_t l = 0; l < L; ++l)
+                        {
+                            partial[l] += term(i + l);
+                        }
+                    }
+                    auto acc = detail::combine(partial);
+                    for (; i < n; ++i)
+                    {
+                        acc += term(i);
+                    }
+                    return acc;
+                }
+                else
+                {
+                    Accum<T> acc = 0;
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        acc += term(i);
+                    }
+                    return acc;
+                }
+            }
+
+            template <class T>
+            Accum<T> sum(const T* src, size_t n)
+            {
+                return reduce<T>(n, [src](size_t i) { return static_cast<Accum<T>>(src[i]); });
+            }
+
+            template <class T>
+            Accum<T> dot(const T* a, const T* b, size_t n)
+            {
+                return reduce<T>(n, [a, b](size_t i) { return static_cast<Accum<T>>(a[i]) * static_cast<Accum<T>>(b[i]); });
+            }
+
+            template <class T>
+            T min(const T* src, size_t n)
+            {
+                T m = src[0];
+                for (size_t i = 1; i < n; ++i)
+                {
+                    m = std::min(m, src[i]);
+                }
+                return m;
+            }
+
+            template <class T>
+            T max(const T* src, size_t n)
+            {
+                T m = src[0];
+                for (size_t i = 1; i < n; ++i)
+                {
+                    m = std::max(m, src[i]);
+                }
+                return m;
+            }
+        }
+
+        /** The kernels which process Simd<T>::width elements at once. Remainders are processed by the scalar kernels. */
+        namespace vectorized
+        {
+            template <class T>
+            SQZ_AVX2_TARGET void add(T* dst, const T* src, size_t n)
+            {
+                using S = Simd<T>;
+                size_t i = 0;
+                for (; i + S::width <= n; i += S::width)
+                {
+                    S::store(dst + i, S::add(S::load(dst + i), S::load(src + i)));
+                }
+                scalar::add(dst + i, src + i, n - i);
+            }
+
+            template <class T>
+            SQZ_AVX2_TARGET void mul(T* dst, const T* src, size_t n)
+            {
+                using S = Simd<T>;
+                size_t i = 0;
+                for (; i + S::width <= n; i += S::width)
+                {
+                    S::store(dst + i, S::mul(S::load(dst + i), S::load(src + i)));
+                }
+                scalar::mul(dst + i, src + i, n - i);
+            }
+
+            template <class T>
+            SQZ_AVX2_TARGET void fma(T* dst, const T* a, const T* b, size_t n)
+            {
+                using S = Simd<T>;
+                size_t i = 0;
+                for (; i + S::width <= n; i += S::width)
+                {
+                    S::store(dst + i, S::fmadd(S::load(a + i), S::load(b + i), S::load(dst + i)));
+                }
+                scalar::fma(dst + i, a + i, b + i, n - i);
+            }
+
+            template <class T>
+            SQZ_AVX2_TARGET void scale(T* dst, T k, size_t n)
+            {
+                using S = Simd<T>;
+                const auto vk = S::set1(k);
+                size_t i = 0;
+                for (; i + S::width <= n; i += S::width)
+                {
+                    S::store(dst + i, S::mul(S::load(dst + i), vk));
+                }
+                scalar::scale(dst + i, k, n - i);
+            }
+
+            template <class T>
+            SQZ_AVX2_TARGET void clamp(T* dst, T lo, T hi, size_t n)
+            {
+                using S = Simd<T>;
+                const auto vlo = S::set1(lo);
+                const auto vhi = S::set1(hi);
+                size_t i = 0;
+                for (; i + S::width <= n; i += S::width)
+                {
+                    S::store(dst + i, S::min(S::max(S::load(dst + i), vlo), vhi));
+                }
+                scalar::clamp(dst + i, lo, hi, n - i);
+            }
+
+            template <class T, class Step, class Term>
+            SQZ_AVX2_TARGET double reduce(size_t n, Step&& step, Term&& term)
+            {
+                using S = Simd<T>;
+                constexpr auto L = detail::lanes<T>;
+                typename S::Acc acc[L / 4];
+                for (auto& a : acc)
+                {
+                    a = S::zero();
+                }
+                size_t i = 0;
+                for (; i + L <= n; i += L)
+                {
+                    step(acc, i);
+                }
+
+                double partial[L];
+                for (size_t k = 0; k < L / 4; ++k)
+                {
+                    S::storeAcc(partial + k * 4, acc[k]);
+                }
+                auto r = detail::combine(partial);
+                for (; i < n; ++i)
+                {
+                    r += term(i);
+                }
+                return r;
+            }
+
+            template <class T>
+            SQZ_AVX2_TARGET double sum(const T* src, size_t n)
+            {
+                return reduce<T>(n,
+                    [src](typename Simd<T>::Acc* acc, size_t i) SQZ_AVX2_TARGET { Simd<T>::sumStep(acc, src + i); },
+                    [src](size_t i) { return static_cast<double>(src[i]); });
+            }
+
+            template <class T>
+            SQZ_AVX2_TARGET double dot(const T* a, const T* b, size_t n)
+            {
+                return reduce<T>(n,
+                    [a, b](typename Simd<T>::Acc* acc, size_t i) SQZ_AVX2_TARGET { Simd<T>::dotStep(acc, a + i, b + i); },
+                    [a, b](size_t i) { return static_cast<double>(a[i]) * static_cast<double>(b[i]); });
+            }
+
+            template <class T>
+            SQZ_AVX2_TARGET T min(const T* src, size_t n)
+            {
+                using S = Simd<T>;
+                if (n < S::width)
+                {
+                    return scalar::min(src, n);
+                }
+                auto v = S::load(src);
+                size_t i = S::width;
+                for (; i + S::width <= n; i += S::width)
+                {
+                    v = S::min(v, S::load(src + i));
+                }
+                const auto m = S::hmin(v);
+                return i < n ? std::min(m, scalar::min(src + i, n - i)) : m;
+            }
+
+            template <class T>
+            SQZ_AVX2_TARGET T max(const T* src, size_t n)
+            {
+                using S = Simd<T>;
+                if (n < S::width)
+                {
+                    return scalar::max(src, n);
+                }
+                auto v = S::load(src);
+                size_t i = S::width;
+                for (; i + S::width <= n; i += S::width)
+                {
+                    v = S::max(v, S::load(src + i));
+                }
+                const auto m = S::hmax(v);
+                return i < n ? std::max(m, scalar::max(src + i, n - i)) : m;
+            }
+        }
+
+        /** dst[i] += src[i] */
+        template <class T>
+        void add(T* dst, const T* src, size_t n)
+        {
+            if constexpr (Simd<T>::enabled)
+            {
+                if (simdEnabled())
+                {
+                    return vectorized::add(dst, src, n);
+                }
+            }
+            scalar::add(dst, src, n);
+        }
+
+        /** dst[i] *= src[i] */
+        template <class T>
+        void mul(T* dst, const T* src, size_t n)
+        {
+            if constexpr (Simd<T>::enabled)
+            {
+                if (simdEnabled())
+                {
+                    return vectorized::mul(dst, src, n);
+                }
+            }
+            scalar::mul(dst, src, n);
+        }
+
+        /** dst[i] += a[i] * b[i] */
+        template <class T>
+        void fma(T* dst, const T* a, const T* b, size_t n)
+        {
+            if constexpr (Simd<T>::enabled)
+            {
+                if (simdEnabled())
+                {
+                    return vectorized::fma(dst, a, b, n);
+                }
+            }
+            scalar::fma(dst, a, b, n);
+        }
+
+        /** dst[i] *= k */
+        template <class T>
+        void scale(T* dst, T k, size_t n)
+        {
+            if constexpr (Simd<T>::enabled)
+            {
+                if (simdEnabled())
+                {
+                    return vectorized::scale(dst, k, n);
+                }
+            }
+            scalar::scale(dst, k, n);
+        }
+
+        /** dst[i] = min(max(dst[i], lo), hi) */
+        template <class T>
+        void clamp(T* dst, T lo, T hi, size_t n)
+        {
+            if constexpr (Simd<T>::enabled)
+            {
+                if (simdEnabled())
+                {
+                    return vectorized::clamp(dst, lo, hi, n);
+                }
+            }
+            scalar::clamp(dst, lo, hi, n);
+        }
+
+        /** Return the sum of elements. The result is the same with or without the vector kernels. */
+        template <class T>
+        Accum<T> sum(const T* src, size_t n)
+        {
+            if constexpr (Simd<T>::enabled)
+            {
+                if (simdEnabled())
+                {
+                    return vectorized::sum(src, n);
+                }
+            }
+            return scalar::sum(src, n);
+        }
+
+        /** Return the sum of products of elements. The result is the same with or without the vector kernels. */
+        template <class T>
+        Accum<T> dot(const T* a, const T* b, size_t n)
+        {
+            if constexpr (Simd<T>::enabled)
+            {
+                if (simdEnabled())
+                {
+                    return vectorized::dot(a, b, n);
+                }
+            }
+            return scalar::dot(a, b, n);
+        }
+
+        /** Return the minimum element. The range must not be empty. */
+        template <class T>
+        T min(const T* src, size_t n)
+        {
+            if constexpr (Simd<T>::enabled)
+            {
+                if (simdEnabled())
+                {
+                    return vectorized::min(src, n);
+                }
+            }
+            return scalar::min(src, n);
+        }
+
+        /** Return the maximum element. The range must not be empty. */
+        template <class T>
+        T max(const T* src, size_t n)
+        {
+            if constexpr (Simd<T>::enabled)
+            {
+                if (simdEnabled())
+                {
+                    return vectorized::max(src, n);
+                }
+            }
+            return scalar::max(src, n);
+        }
+    }
+
+    namespace detail
+    {
+        /** Convert a real to T. Integers are saturated to the range of T, and NaN becomes 0. */
+        template <class T>
+        T saturate(double x)
+        {
+            if constexpr (std::is_integral<T>::value)
+            {
+                if (std::isnan(x))
+                {
+                    return 0;
+                }
+                if (x <= static_cast<double>(std::numeric_limits<T>::min()))
+                {
+                    return std::numeric_limits<T>::min();
+                }
+                if (x >= static_cast<double>(std::numeric_limits<T>::max()))
+                {
+                    return std::numeric_limits<T>::max();
+                }
+                return static_cast<T>(x);
+            }
+            else
+            {
+                return static_cast<T>(x);
+            }
+        }
+
+        /** A numeric buffer or a blob passed to kernels. Blobs are regarded as float32 buffers. */
+        struct KernelOperand
+        {
+            void* data;
+            SQInteger size;
+            BufferType type;
+            bool readOnly;
+        };
+
+        /** The closures of the kernel library */
+        struct KernelClosure
+        {
+            static bool operand(HSQUIRRELVM vm, SQInteger id, KernelOperand& op)
+            {
+                SQUserPointer p;
+                SQUserPointer tag;
+                if (sq_gettype(vm, id) == OT_USERDATA && SQ_SUCCEEDED(sq_getuserdata(vm, id, &p, &tag)))
+                {
+                    if (tag != typeTag<BufferData>())
+                    {
+                        return false;
+                    }
+                    const auto buf = static_cast<BufferData*>(p);
+                    op = { buf->data, buf->size, buf->type, buf->readOnly };
+                    return true;
+                }
+                if (SQ_SUCCEEDED(sqstd_getblob(vm, id, &p)))
+                {
+                    op = { p, sqstd_getblobsize(vm, id) / static_cast<SQInteger>(sizeof(float)), BufferType::Float32, false };
+                    return true;
+                }
+                return false;
+            }
+
+            template <class F>
+            static SQInteger dispatch(BufferType type, F&& f)
+            {
+                switch (type)
+                {
+                case BufferType::Float32: return f(static_cast<float*>(nullptr));
+                case BufferType::Float64: return f(static_cast<double*>(nullptr));
+                case BufferType::Int32: return f(static_cast<std::int32_t*>(nullptr));
+                case BufferType::UInt8: return f(static_cast<std::uint8_t*>(nullptr));
+                }
+                return 0;
+            }
+
+            /** Get operands at 2, 3, ... Every operand has the same type and the same size. */
+            template <size_t N>
+            static SQInteger operands(HSQUIRRELVM vm, KernelOperand (&ops)[N], bool write)
+            {
+                for (size_t i = 0; i < N; ++i)
+                {
+                    if (!operand(vm, static_cast<SQInteger>(i + 2), ops[i]))
+                    {
+                        return sq_throwerror(vm, SQZ_T("The operand is not a buffer or a blob."));
+                    }
+                    if (ops[i].type != ops[0].type || ops[i].size != ops[0].size)
+                    {
+                        return sq_throwerror(vm, SQZ_T("The operands differ in the type or the size."));
+                    }
+                }
+                if (write && ops[0].readOnly)
+                {
+                    return sq_throwerror(vm, SQZ_T("The buffer is read-only."));
+                }
+                return 0;
+            }
+
+            static SQInteger add(HSQUIRRELVM vm)
+            {
+                KernelOperand ops[2];
+                if (const auto r = operands(vm, ops, true)) { return r; }
+                return dispatch(ops[0].type, [&](auto t)
+                {
+                    using T = std::remove_pointer_t<decltype(t)>;
+                    kernel::add(static_cast<T*>(ops[0].data), static_cast<const T*>(ops[1].data), static_cast<size_t>(ops[0].size));
+                    return SQInteger(0);
+                });
+            }
+
+            static SQInteger mul(HSQUIRRELVM vm)
+            {
+                KernelOperand ops[2];
+                if (const auto r = operands(vm, ops, true)) { return r; }
+                return dispatch(ops[0].type, [&](auto t)
+                {
+                    using T = std::remove_pointer_t<decltype(t)>;
+                    kernel::mul(static_cast<T*>(ops[0].data), static_cast<const T*>(ops[1].data), static_cast<size_t>(ops[0].size));
+                    return SQInteger(0);
+                });
+            }
+
+            static SQInteger fma(HSQUIRRELVM vm)
+            {
+                KernelOperand ops[3];
+                if (const auto r = operands(vm, ops, true)) { return r; }
+                return dispatch(ops[0].type, [&](auto t)
+                {
+                    using T = std::remove_pointer_t<decltype(t)>;
+                    kernel::fma(static_cast<T*>(ops[0].data), static_cast<const T*>(ops[1].data), static_cast<const T*>(ops[2].data), static_cast<size_t>(ops[0].size));
+                    return SQInteger(0);
+                });
+            }
+
+            static SQInteger scale(HSQUIRRELVM vm)
+            {
+                KernelOperand ops[1];
+                if (const auto r = operands(vm, ops, true)) { return r; }
+                SQFloat k;
+                sq_getfloat(vm, 3, &k);
+                return dispatch(ops[0].type, [&](auto t)
+                {
+                    using T = std::remove_pointer_t<decltype(t)>;
+                    const auto dst = static_cast<T*>(ops[0].data);
+                    const auto n = static_cast<size_t>(ops[0].size);
+                    if constexpr (std::is_integral<T>::value)
+                    {
+                        // The factor may be fractional, so products are computed in double and rounded.
+                        for (size_t i = 0; i < n; ++i)
+                        {
+                            dst[i] = saturate<T>(std::round(dst[i] * static_cast<double>(k)));
+                        }
+                    }
+                    else
+                    {
+                        kernel::scale(dst, static_cast<T>(k), n);
+                    }
+                    return SQInteger(0);
+                });
+            }
+
+            static SQInteger clamp(HSQUIRRELVM vm)
+            {
+                KernelOperand ops[1];
+                if (const auto r = operands(vm, ops, true)) { return r; }
+                SQFloat lo;
+                SQFloat hi;
+                sq_getfloat(vm, 3, &lo);
+                sq_getfloat(vm, 4, &hi);
+                return dispatch(ops[0].type, [&](auto t)
+                {
+                    using T = std::remove_pointer_t<decltype(t)>;
+                    // Integer bounds are rounded inward, and saturated to the range of T.
+                    const auto l = std::is_integral<T>::value ? std::ceil(lo) : lo;
+                    const auto h = std::is_integral<T>::value ? std::floor(hi) : hi;
+                    kernel::clamp(static_cast<T*>(ops[0].data), saturate<T>(l), saturate<T>(h), static_cast<size_t>(ops[0].size));
+                    return SQInteger(0);
+                });
+            }
+
+            static SQInteger sum(HSQUIRRELVM vm)
+            {
+                KernelOperand ops[1];
+                if (const auto r = operands(vm, ops, false)) { return r; }
+                return dispatch(ops[0].type, [&](auto t)
+                {
+                    using T = std::remove_pointer_t<decltype(t)>;
+                    pushValue(vm, kernel::sum(static_cast<const T*>(ops[0].data), static_cast<size_t>(ops[0].size)));
+                    return SQInteger(1);
+                });
+            }
+
+            static SQInteger dot(HSQUIRRELVM vm)
+            {
+                KernelOperand ops[2];
+                if (const auto r = operands(vm, ops, false)) { return r; }
+                return dispatch(ops[0].type, [&](auto t)
+                {
+                    using T = std::remove_pointer_t<decltype(t)>;
+                    pushValue(vm, kernel::dot(static_cast<const T*>(ops[0].data), static_cast<const T*>(ops[1].data), static_cast<size_t>(ops[0].size)));
+                    return SQInteger(1);
+                });
+            }
+
+            static SQInteger min(HSQUIRRELVM vm)
+            {
+                KernelOperand ops[1];
+                if (const auto r = operands(vm, ops, false)) { return r; }
+                if (ops[0].size == 0)
+                {
+                    return sq_throwerror(vm, SQZ_T("The buffer is empty."));
+                }
+                return dispatch(ops[0].type, [&](auto t)
+                {
+                    using T = std::remove_pointer_t<decltype(t)>;
+                    pushValue(vm, kernel::min(static_cast<const T*>(ops[0].data), static_cast<size_t>(ops[0].size)));
+                    return SQInteger(1);
+                });
+            }
+
+            static SQInteger max(HSQUIRRELVM vm)
+            {
+                KernelOperand ops[1];
+                if (const auto r = operands(vm, ops, false)) { return r; }
+                if (ops[0].size == 0)
+                {
+                    return sq_throwerror(vm, SQZ_T("The buffer is empty."));
+                }
+                return dispatch(ops[0].type, [&](auto t)
+                {
+                    using T = std::remove_pointer_t<decltype(t)>;
+                    pushValue(vm, kernel::max(static_cast<const T*>(ops[0].data), static_cast<size_t>(ops[0].size)));
+                    return SQInteger(1);
+                });
+            }
+        };
+
+        /** Register the kernel library as the 'kernel' table into the table on the top of the stack. */
+        inline void registerKernelLib(HSQUIRRELVM vm)
+        {
+            const struct
+            {
+                const SQChar* name;
+                SQFUNCTION f;
+                SQInteger nparams;
+                const SQChar* typemask;
+            }
+            functions[] =
+            {
+                { SQZ_T("add"), KernelClosure::add, 3, SQZ_T(".u|xu|x") },
+                { SQZ_T("mul"), KernelClosure::mul, 3, SQZ_T(".u|xu|x") },
+                { SQZ_T("fma"), KernelClosure::fma, 4, SQZ_T(".u|xu|xu|x") },
+                { SQZ_T("scale"), KernelClosure::scale, 3, SQZ_T(".u|xn") },
+                { SQZ_T("clamp"), KernelClosure::clamp, 4, SQZ_T(".u|xnn") },
+                { SQZ_T("sum"), KernelClosure::sum, 2, SQZ_T(".u|x") },
+                { SQZ_T("dot"), KernelClosure::dot, 3, SQZ_T(".u|xu|x") },
+                { SQZ_T("min"), KernelClosure::min, 2, SQZ_T(".u|x") },
+                { SQZ_T("max"), KernelClosure::max, 2, SQZ_T(".u|x") },
+            };
+
+            sq_pushstring(vm, SQZ_T("kernel"), -1);
+            sq_newtableex(vm, sizeof(functions) / sizeof(functions[0]));
+            for (const auto& f : functions)
+            {
+                sq_pushstring(vm, f.name, -1);
+                sq_newclosure(vm, f.f, 0);
+                sq_setparamscheck(vm, f.nparams, f.typemask);
+                sq_setnativeclosurename(vm, -1, f.name);
+                sq_newslot(vm, -3, SQFalse);
+            }
+            sq_newslot(vm, -3, SQFalse);
+        }
+    }
+}
+
+#endif
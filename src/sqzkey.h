@@ -0,0 +1,121 @@
+#ifndef SQUEEZE_SQZKEY_H
+#define SQUEEZE_SQZKEY_H
+
+#include "sqzobject.h"
+#include "sqzvm.h"
+#include "sqzdef.h"
+#include <squirrel.h>
+
+namespace squeeze
+{
+    /**
+    The Key object handle.
+    The string is interned in the VM once, so pushing the key needs no hashing.
+    */
+    class HKey : public HObject
+    {
+    public:
+        /** Construct */
+        HKey() = default;
+
+        /** Intern a string as a key */
+        HKey(HVM vm, string_view_t key)
+        {
+            vm_ = vm;
+            const auto top = sq_gettop(vm_);
+            sq_pushstring(vm_, key.data(), key.length());
+            sq_getstackobj(vm_, -1, &obj_);
+            sq_addref(vm_, &obj_);
+            sq_settop(vm_, top);
+        }
+    };
+
+    /** The key argument accepted by table and class operations */
+    class Key
+    {
+    private:
+        const SQChar* str_;
+        SQInteger length_;
+        HSQOBJECT obj_;
+
+    public:
+        /** Refer to a string */
+        Key(const string_t& key)
+            : str_(key.c_str())
+            , length_(key.length())
+            , obj_()
+        {
+            sq_resetobject(&obj_);
+        }
+
+        /// ditto
+        Key(string_view_t key)
+            : str_(key.data())
+            , length_(key.length())
+            , obj_()
+        {
+            sq_resetobject(&obj_);
+        }
+
+        /// ditto
+        template <class T, class = EnableChars<T>>
+        Key(T key)
+            : str_(key)
+            , length_(-1)
+            , obj_()
+        {
+            sq_resetobject(&obj_);
+        }
+
+        /** Refer to a string literal or a constant character array. */
+        template <size_t N>
+        Key(const SQChar(&key)[N])
+            : str_(key)
+            , length_(stringLength(key))
+            , obj_()
+        {
+            sq_resetobject(&obj_);
+        }
+
+        /** Refer to a character buffer. The length is not known at compile time. */
+        template <size_t N>
+        Key(SQChar(&key)[N])
+            : str_(key)
+            , length_(-1)
+            , obj_()
+        {
+            sq_resetobject(&obj_);
+        }
+
+        /** Refer to an interned key */
+        Key(const HKey& key)
+            : str_(nullptr)
+            , length_(0)
+            , obj_(key)
+        {
+        }
+
+        /** Push the key into the stack */
+        void push(HSQUIRRELVM vm) const
+        {
+            if (str_)
+            {
+                sq_pushstring(vm, str_, length_);
+            }
+            else
+            {
+                sq_pushobject(vm, obj_);
+            }
+        }
+    };
+
+    /** Push the values into the stack. */
+    template <class... Ts>
+    void pushValue(HSQUIRRELVM vm, const Key& key, Ts&&... values)
+    {
+        key.push(vm);
+        pushValue(vm, std::forward<Ts>(values)...);
+    }
+}
+
+#endif
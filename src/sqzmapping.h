@@ -0,0 +1,102 @@
+#ifndef SQUEEZE_SQZMAPPING_H
+#define SQUEEZE_SQZMAPPING_H
+
+/**
+The implementation of file mappings for HBundle.
+This header is not included by squeeze.h, because it includes the platform headers.
+Include it in exactly one source file of a program which opens bundles.
+*/
+
+#include "sqzbundle.h"
+#include "sqzdef.h"
+#include <filesystem>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace squeeze
+{
+    namespace detail
+    {
+        void* mapFile(const std::filesystem::path& path, const unsigned char*& data, size_t& size)
+        {
+#ifdef _WIN32
+            const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            LARGE_INTEGER fileSize;
+            if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+            {
+                if (file != INVALID_HANDLE_VALUE)
+                {
+                    CloseHandle(file);
+                }
+                throw ScriptException("The bundle can not be opened.");
+            }
+
+            // The mapping keeps the file open, so the file handle is closed here.
+            const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            CloseHandle(file);
+            const auto p = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (!p)
+            {
+                if (mapping)
+                {
+                    CloseHandle(mapping);
+                }
+                throw ScriptException("The bundle can not be mapped.");
+            }
+            data = static_cast<const unsigned char*>(p);
+            size = static_cast<size_t>(fileSize.QuadPart);
+            return mapping;
+#else
+            const auto fd = ::open(path.c_str(), O_RDONLY);
+            struct stat st;
+            if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0)
+            {
+                if (fd >= 0)
+                {
+                    ::close(fd);
+                }
+                throw ScriptException("The bundle can not be opened.");
+            }
+            const auto p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (p == MAP_FAILED)
+            {
+                throw ScriptException("The bundle can not be mapped.");
+            }
+            data = static_cast<const unsigned char*>(p);
+            size = static_cast<size_t>(st.st_size);
+            return nullptr;
+#endif
+        }
+
+        void unmapFile(const unsigned char* data, size_t size, void* handle)
+        {
+#ifdef _WIN32
+            static_cast<void>(size);
+            if (data)
+            {
+                UnmapViewOfFile(data);
+            }
+            if (handle)
+            {
+                CloseHandle(handle);
+            }
+#else
+            static_cast<void>(handle);
+            if (data)
+            {
+                munmap(const_cast<unsigned char*>(data), size);
+            }
+#endif
+        }
+    }
+}
+
+#endif
@@ -74,7 +74,7 @@ namespace squeeze
         }
 
         /** Cast to HSQOBJECT */
-        operator HSQOBJECT()
+        operator HSQOBJECT() const
         {
             return obj_;
         }
@@ -0,0 +1,301 @@
+#ifndef SQUEEZE_SQZPOOL_H
+#define SQUEEZE_SQZPOOL_H
+
+#include "sqzvm.h"
+#include "sqzdef.h"
+#include <squirrel.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace squeeze
+{
+    /**
+    The pool of VMs which are built once and handed out to threads.
+    A VM is used by one thread at a time, and its stack is reset when it is returned.
+    A VM whose reset throws is rebuilt by the initializer, and retired if it can not be rebuilt.
+    */
+    class HVMPool
+    {
+    public:
+        /** The function which builds or resets a VM */
+        using Initializer = std::function<void(HVM&)>;
+
+        /** The exclusive use of a VM in the pool. The VM is returned when the lease is destructed. */
+        class Lease
+        {
+        private:
+            HVMPool* pool_;
+            size_t index_;
+
+            friend class HVMPool;
+
+            Lease(HVMPool* pool, size_t index)
+                : pool_(pool)
+                , index_(index)
+            {
+            }
+
+        public:
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+
+            /** Move */
+            Lease(Lease&& that)
+                : pool_(that.pool_)
+                , index_(that.index_)
+            {
+                that.pool_ = nullptr;
+            }
+
+            /** Move */
+            Lease& operator=(Lease&& that)
+            {
+                if (this != &that)
+                {
+                    release();
+                    pool_ = that.pool_;
+                    index_ = that.index_;
+                    that.pool_ = nullptr;
+                }
+                return *this;
+            }
+
+            /** Return the VM */
+            ~Lease()
+            {
+                release();
+            }
+
+            /** Return the leased VM */
+            HVM& vm()
+            {
+                return pool_->vms_[index_];
+            }
+
+            /// ditto
+            HVM* operator->()
+            {
+                return &vm();
+            }
+
+            /** Return the VM to the pool before the lease is destructed */
+            void release()
+            {
+                if (pool_)
+                {
+                    pool_->giveBack(index_);
+                    pool_ = nullptr;
+                }
+            }
+        };
+
+    private:
+        std::vector<HVM> vms_;
+        std::vector<size_t> free_;
+        std::unordered_map<std::thread::id, size_t> pinned_;
+        Initializer init_;
+        Initializer reset_;
+        size_t stackSize_;
+        size_t live_;
+        std::mutex mutex_;
+        std::condition_variable available_;
+
+        size_t take(std::unique_lock<std::mutex>& lock)
+        {
+            available_.wait(lock, [this] { return !free_.empty() || live_ == 0; });
+            if (free_.empty())
+            {
+                throw ObjectHandlingFailed("All VMs in the pool are retired.");
+            }
+            const auto index = free_.back();
+            free_.pop_back();
+            return index;
+        }
+
+        void resetVM(size_t index)
+        {
+            auto& vm = vms_[index];
+            sq_settop(vm, 0);
+            sq_reseterror(vm);
+            if (reset_)
+            {
+                reset_(vm);
+            }
+        }
+
+        void close()
+        {
+            for (auto& vm : vms_)
+            {
+                if (vm.valid())
+                {
+                    vm.close();
+                }
+            }
+        }
+
+        bool rebuildVM(size_t index)
+        {
+            auto& vm = vms_[index];
+            try
+            {
+                // A new handle is used, so objects of the old VM keep the invalidated flag and do not release into the new one.
+                vm.close();
+                vm = HVM();
+                vm.open(stackSize_);
+                init_(vm);
+                sq_settop(vm, 0);
+                return true;
+            }
+            catch (...)
+            {
+                if (vm.valid())
+                {
+                    vm.close();
+                }
+                return false;
+            }
+        }
+
+        void giveBack(size_t index)
+        {
+            // This is called by the destructor of a lease, so an exception of the reset must not escape.
+            bool usable = true;
+            try
+            {
+                resetVM(index);
+            }
+            catch (...)
+            {
+                usable = rebuildVM(index);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (usable)
+                {
+                    free_.push_back(index);
+                }
+                else
+                {
+                    --live_;
+                }
+            }
+            // Waiters must see that the last VM is retired.
+            available_.notify_all();
+        }
+
+    public:
+        /**
+        Open 'count' VMs and build each of them by 'init'.
+        'reset' is called when a VM is returned, to clear the state of a request.
+        */
+        HVMPool(size_t count, size_t stackSize, const Initializer& init, Initializer reset = nullptr)
+            : vms_(count)
+            , free_()
+            , pinned_()
+            , init_(init)
+            , reset_(std::move(reset))
+            , stackSize_(stackSize)
+            , live_(count)
+            , mutex_()
+            , available_()
+        {
+            free_.reserve(count);
+            try
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    vms_[i].open(stackSize);
+                    init(vms_[i]);
+                    sq_settop(vms_[i], 0);
+                    free_.push_back(count - i - 1);
+                }
+            }
+            catch (...)
+            {
+                close();
+                throw;
+            }
+        }
+
+        HVMPool(const HVMPool&) = delete;
+        HVMPool& operator=(const HVMPool&) = delete;
+
+        /** Close all VMs. Every lease must be returned before. */
+        ~HVMPool()
+        {
+            close();
+        }
+
+        /** Return the number of VMs */
+        size_t size() const
+        {
+            return vms_.size();
+        }
+
+        /** Lease a VM. Wait until a VM is returned if all VMs are used. Throw if all VMs are retired. */
+        Lease lease()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            return Lease(this, take(lock));
+        }
+
+        /** Lease a VM if a VM is available. */
+        std::optional<Lease> tryLease()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (free_.empty())
+            {
+                return std::nullopt;
+            }
+            const auto index = free_.back();
+            free_.pop_back();
+            return Lease(this, index);
+        }
+
+        /**
+        Return the VM pinned to the calling thread.
+        A VM is taken out of the pool on the first call, and the thread keeps it until unpin() is called.
+        The VM is not returned when the thread exits, so a thread must call unpin() before it exits.
+        Otherwise the VM is lost to the pool until the pool is destructed.
+        */
+        HVM& pin()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            const auto id = std::this_thread::get_id();
+            const auto it = pinned_.find(id);
+            if (it != pinned_.end())
+            {
+                return vms_[it->second];
+            }
+            const auto index = take(lock);
+            pinned_.emplace(id, index);
+            return vms_[index];
+        }
+
+        /** Return the VM pinned to the calling thread to the pool. */
+        void unpin()
+        {
+            size_t index;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                const auto it = pinned_.find(std::this_thread::get_id());
+                if (it == pinned_.end())
+                {
+                    return;
+                }
+                index = it->second;
+                pinned_.erase(it);
+            }
+            giveBack(index);
+        }
+    };
+}
+
+#endif
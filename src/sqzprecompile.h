@@ -0,0 +1,170 @@
+#ifndef SQUEEZE_SQZPRECOMPILE_H
+#define SQUEEZE_SQZPRECOMPILE_H
+
+#include "sqzscript.h"
+#include "sqzvm.h"
+#include "sqzdef.h"
+#include "sqzutil.h"
+#include <squirrel.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace squeeze
+{
+    /** The error of a script which is found by precompilation */
+    struct Diagnostic
+    {
+        string_t path;
+        SQInteger line;
+        SQInteger column;
+        std::string message;
+    };
+
+    /** A script which is compiled to bytecode. The bytecode is empty if the compilation failed. */
+    struct PrecompiledScript
+    {
+        string_t path;
+        std::vector<unsigned char> bytecode;
+        std::optional<Diagnostic> error;
+    };
+
+    /** The result of precompilation */
+    struct PrecompileReport
+    {
+        /** Scripts in the order of the given paths */
+        std::vector<PrecompiledScript> scripts;
+
+        /** Errors in the order of the given paths */
+        std::vector<Diagnostic> diagnostics;
+
+        /** Whether all scripts are compiled or not */
+        bool succeeded() const
+        {
+            return diagnostics.empty();
+        }
+    };
+
+    /**
+    The compiler of many scripts to bytecode in parallel.
+    Each worker thread owns a scratch VM, and takes the next script until all scripts are compiled.
+    The report does not depend on the number of threads or the order of completion.
+    */
+    class Precompiler
+    {
+    private:
+        size_t threads_;
+        size_t stackSize_;
+
+        static void compilerError(HSQUIRRELVM vm, const SQChar* desc, const SQChar*, SQInteger line, SQInteger column)
+        {
+            const auto script = static_cast<PrecompiledScript*>(sq_getforeignptr(vm));
+            if (script && !script->error)
+            {
+                script->error = Diagnostic{ script->path, line, column, narrow(string_t(desc)) };
+            }
+        }
+
+        void work(std::vector<PrecompiledScript>& scripts, std::atomic<size_t>& next) const
+        {
+            HVM vm;
+            vm.open(stackSize_);
+            sq_setcompilererrorhandler(vm, compilerError);
+
+            for (auto i = next++; i < scripts.size(); i = next++)
+            {
+                auto& script = scripts[i];
+                sq_setforeignptr(vm, &script);
+                try
+                {
+                    HScript compiler(vm);
+                    compiler.compileFile(script.path);
+                    script.bytecode = compiler.saveBytecode();
+                }
+                catch (const std::exception& e)
+                {
+                    script.bytecode.clear();
+                    if (!script.error)
+                    {
+                        script.error = Diagnostic{ script.path, 0, 0, e.what() };
+                    }
+                }
+                sq_settop(vm, 0);
+                sq_reseterror(vm);
+            }
+
+            sq_setforeignptr(vm, nullptr);
+            vm.close();
+        }
+
+    public:
+        /** Use 'threads' worker threads. The number of hardware threads is used if 'threads' is 0. */
+        explicit Precompiler(size_t threads = 0, size_t stackSize = 1024)
+            : threads_(threads ? threads : std::max(1u, std::thread::hardware_concurrency()))
+            , stackSize_(stackSize)
+        {
+        }
+
+        /** Return the number of worker threads */
+        size_t threads() const
+        {
+            return threads_;
+        }
+
+        /** Compile script files. */
+        PrecompileReport compile(const std::vector<string_t>& paths) const
+        {
+            PrecompileReport report;
+            report.scripts.resize(paths.size());
+            for (size_t i = 0; i < paths.size(); ++i)
+            {
+                report.scripts[i].path = paths[i];
+            }
+
+            std::atomic<size_t> next(0);
+            std::vector<std::thread> workers;
+            std::vector<std::exception_ptr> failures(std::min(threads_, paths.size()));
+            for (size_t t = 0; t < failures.size(); ++t)
+            {
+                workers.emplace_back([&, t]
+                {
+                    try
+                    {
+                        work(report.scripts, next);
+                    }
+                    catch (...)
+                    {
+                        failures[t] = std::current_exception();
+                        next = paths.size();
+                    }
+                });
+            }
+            for (auto& w : workers)
+            {
+                w.join();
+            }
+            for (const auto& f : failures)
+            {
+                if (f)
+                {
+                    std::rethrow_exception(f);
+                }
+            }
+
+            for (const auto& s : report.scripts)
+            {
+                if (s.error)
+                {
+                    report.diagnostics.push_back(*s.error);
+                }
+            }
+            return report;
+        }
+    };
+}
+
+#endif
@@ -2,17 +2,31 @@
 #define SQUEEZE_SQZSQRIPT_H
 
 #include "sqztable.h"
+#include "sqzbytecode.h"
 #include "sqzobject.h"
 #include "sqzdef.h"
 #include "sqzutil.h"
 #include <squirrel.h>
 #include <sqstdio.h>
+#include <filesystem>
+#include <vector>
+#include <type_traits>
 
 namespace squeeze
 {
     /** The script objetc handle */
     class HScript : public HObject
     {
+    private:
+        BytecodeCache cache_;
+
+        void hold()
+        {
+            sq_getstackobj(vm_, -1, &obj_);
+            sq_addref(vm_, &obj_);
+            sq_poptop(vm_);
+        }
+
     public:
         /** Construct */
         HScript() = default;
@@ -23,17 +37,115 @@ namespace squeeze
             vm_ = vm;
         }
 
+        /**
+        Use a bytecode cache for compileFile().
+        A script found in the cache is loaded without compiling, and a compiled script is written to the cache.
+        */
+        HScript& useCache(const BytecodeCache& cache)
+        {
+            cache_ = cache;
+            return *this;
+        }
+
         /** Compile script code */
         void compileFile(const string_t& path)
         {
             release();
+
+            std::filesystem::path entry;
+            if (cache_.enabled())
+            {
+                std::vector<unsigned char> source;
+                if (detail::readFile(path, source))
+                {
+                    entry = cache_.entry(path, source);
+                    if (cache_.load(vm_, entry))
+                    {
+                        hold();
+                        return;
+                    }
+                }
+            }
+
             if (SQ_FAILED(sqstd_loadfile(vm_, path.c_str(), SQTrue)))
             {
                 failed<ScriptException>(vm_, "sqstd_loadfile() failed.");
             }
-            sq_getstackobj(vm_, -1, &obj_);
-            sq_addref(vm_, &obj_);
+            if (!entry.empty())
+            {
+                cache_.store(vm_, entry);
+            }
+            hold();
+        }
+
+        /** Compile script code in a memory. 'name' is used in error messages and debug informations. */
+        void compileBuffer(string_view_t source, const string_t& name)
+        {
+            release();
+            if (SQ_FAILED(sq_compilebuffer(vm_, source.data(), static_cast<SQInteger>(source.length()), name.c_str(), SQTrue)))
+            {
+                failed<ScriptException>(vm_, "sq_compilebuffer() failed.");
+            }
+            hold();
+        }
+
+        /**
+        Compile script code which is read by 'reader'.
+        'reader' is called with no argument and returns the next character, or 0 at the end of the code.
+        */
+        template <class Reader>
+        void compile(Reader&& reader, const string_t& name)
+        {
+            using R = std::remove_reference_t<Reader>;
+            release();
+            if (SQ_FAILED(sq_compile(vm_, detail::LexReader<R>::read, const_cast<std::remove_const_t<R>*>(&reader), name.c_str(), SQTrue)))
+            {
+                failed<ScriptException>(vm_, "sq_compile() failed.");
+            }
+            hold();
+        }
+
+        /// ditto
+        void compile(SQLEXREADFUNC reader, SQUserPointer up, const string_t& name)
+        {
+            release();
+            if (SQ_FAILED(sq_compile(vm_, reader, up, name.c_str(), SQTrue)))
+            {
+                failed<ScriptException>(vm_, "sq_compile() failed.");
+            }
+            hold();
+        }
+
+        /** Load a compiled script which is written by saveBytecode(). */
+        void loadBytecode(Span<const unsigned char> bytecode)
+        {
+            release();
+            detail::MemoryReader reader{ bytecode.data(), bytecode.size(), 0 };
+            if (SQ_FAILED(sq_readclosure(vm_, detail::MemoryReader::read, &reader)))
+            {
+                failed<ScriptException>(vm_, "sq_readclosure() failed.");
+            }
+            hold();
+        }
+
+        /** Return the compiled script as bytecode. */
+        std::vector<unsigned char> saveBytecode()
+        {
+            if (sq_isnull(obj_))
+            {
+                throw ScriptException("The script is not compiled.");
+            }
+
+            std::vector<unsigned char> bytecode;
+            detail::MemoryWriter writer{ &bytecode };
+            sq_pushobject(vm_, obj_);
+            if (SQ_FAILED(sq_writeclosure(vm_, detail::MemoryWriter::write, &writer)))
+            {
+                sq_poptop(vm_);
+                failed<ScriptException>(vm_, "sq_writeclosure() failed.");
+            }
             sq_poptop(vm_);
+            return bytecode;
         }
 
         /** Run the compiled script */
@@ -5,10 +5,41 @@
 #include "sqzutil.h"
 #include <squirrel.h>
 #include <type_traits>
+#include <array>
+#include <memory>
 #include <cstring>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <new>
 
 namespace squeeze
 {
+    // Conversions of containers and structs convert their elements recursively, so they are declared first.
+    template <class T, class... Ts>
+    EnableSequence<T> pushValue(HSQUIRRELVM vm, const T& val, Ts&&... values);
+
+    template <class T, class... Ts>
+    EnableAssociative<T> pushValue(HSQUIRRELVM vm, const T& val, Ts&&... values);
+
+    template <class T, class... Ts>
+    EnableReflected<T> pushValue(HSQUIRRELVM vm, const T& val, Ts&&... values);
+
+    template <class T>
+    auto getValue(HSQUIRRELVM vm, int id)
+        -> std::enable_if_t<IsVector<T>::value, std::decay_t<T>>;
+
+    template <class T>
+    auto getValue(HSQUIRRELVM vm, int id)
+        -> std::enable_if_t<IsStdArray<T>::value, std::decay_t<T>>;
+
+    template <class T>
+    EnableAssociative<T, std::decay_t<T>> getValue(HSQUIRRELVM vm, int id);
+
+    template <class T>
+    EnableReflected<T, std::decay_t<T>> getValue(HSQUIRRELVM vm, int id);
+
     /** Push the values into the stack. */
     template <class T, class... Ts>
     EnableInteger<T> pushValue(HSQUIRRELVM vm, T val, Ts&&... values)
@@ -44,6 +75,22 @@ namespace squeeze
         pushValue(vm, std::forward<Ts>(values)...);
     }
 
+    /// ditto
+    template <size_t N, class... Ts>
+    void pushValue(HSQUIRRELVM vm, const SQChar(&val)[N], Ts&&... values)
+    {
+        sq_pushstring(vm, val, stringLength(val));
+        pushValue(vm, std::forward<Ts>(values)...);
+    }
+
+    /// ditto
+    template <size_t N, class... Ts>
+    void pushValue(HSQUIRRELVM vm, SQChar(&val)[N], Ts&&... values)
+    {
+        sq_pushstring(vm, val, -1);
+        pushValue(vm, std::forward<Ts>(values)...);
+    }
+
     /// ditto
     template <class T, class... Ts>
     EnableString<T> pushValue(HSQUIRRELVM vm, const T& val, Ts&&... values)
@@ -52,6 +99,14 @@ namespace squeeze
         pushValue(vm, std::forward<Ts>(values)...);
     }
 
+    /// ditto
+    template <class T, class... Ts>
+    EnableStringView<T> pushValue(HSQUIRRELVM vm, T val, Ts&&... values)
+    {
+        sq_pushstring(vm, val.data(), val.length());
+        pushValue(vm, std::forward<Ts>(values)...);
+    }
+
     /// ditto
     template <class T, class... Ts>
     auto pushValue(HSQUIRRELVM vm, T val, Ts&&... values)
@@ -70,6 +125,56 @@ namespace squeeze
         pushValue(vm, std::forward<Ts>(values)...);
     }
 
+    namespace detail
+    {
+        /** Push an array which elements are copied from a range. */
+        template <class It>
+        void pushArray(HSQUIRRELVM vm, It first, SQInteger size)
+        {
+            sq_newarray(vm, size);
+            for (SQInteger i = 0; i < size; ++i, ++first)
+            {
+                sq_pushinteger(vm, i);
+                pushValue(vm, *first);
+                sq_rawset(vm, -3);
+            }
+        }
+    }
+
+    /// ditto
+    template <class T, class... Ts>
+    EnableSequence<T> pushValue(HSQUIRRELVM vm, const T& val, Ts&&... values)
+    {
+        detail::pushArray(vm, val.begin(), static_cast<SQInteger>(val.size()));
+        pushValue(vm, std::forward<Ts>(values)...);
+    }
+
+    /// ditto
+    template <class T, class... Ts>
+    EnableAssociative<T> pushValue(HSQUIRRELVM vm, const T& val, Ts&&... values)
+    {
+        sq_newtableex(vm, static_cast<SQInteger>(val.size()));
+        for (const auto& slot : val)
+        {
+            pushValue(vm, slot.first, slot.second);
+            sq_rawset(vm, -3);
+        }
+        pushValue(vm, std::forward<Ts>(values)...);
+    }
+
+    /// ditto
+    template <class T, class... Ts>
+    EnableReflected<T> pushValue(HSQUIRRELVM vm, const T& val, Ts&&... values)
+    {
+        constexpr auto& fields = Reflect<std::remove_cv_t<T>>::fields;
+        sq_newtableex(vm, static_cast<SQInteger>(std::tuple_size<std::decay_t<decltype(fields)>>::value));
+        std::apply([&](const auto&... field)
+        {
+            ((sq_pushstring(vm, field.name, field.length), pushValue(vm, val.*field.member), sq_rawset(vm, -3)), ...);
+        }, fields);
+        pushValue(vm, std::forward<Ts>(values)...);
+    }
+
     struct UserData
     {
         const void* p;
@@ -86,6 +191,60 @@ namespace squeeze
         pushValue(vm, values...);
     }
 
+    /**
+    Push a user data which holds an object constructed in place, and return the object.
+    Unlike UserData, the object is not copied by bytes and is destructed when the user data is released.
+    The type tag of the user data is of T.
+    */
+    template <class T, class... Args>
+    T* newUserData(HSQUIRRELVM vm, Args&&... args)
+    {
+        static_assert(alignof(T) <= alignof(SQUserPointer), "The user data is not aligned for the type.");
+
+        const auto p = new (sq_newuserdata(vm, sizeof(T))) T(std::forward<Args>(args)...);
+        sq_setreleasehook(vm, -1, [](SQUserPointer p, SQInteger) -> SQInteger
+        {
+            static_cast<T*>(p)->~T();
+            return 0;
+        });
+        sq_settypetag(vm, -1, typeTag<T>());
+        return p;
+    }
+
+    /**
+    The property accessor which is called by the _get and _set metamethods without a nested call.
+    The user data of an accessor holds the function followed by the bytes of the bound callable.
+    */
+    struct PropertyAccessor
+    {
+        using Function = SQInteger(*)(HSQUIRRELVM vm, const void* f);
+
+        Function fn;
+        UserData f;
+        PropertyAccessor(Function fn_, const UserData& f_) : fn(fn_), f(f_) {}
+
+        /** Call the accessor held by a user data */
+        static SQInteger invoke(HSQUIRRELVM vm, SQUserPointer p)
+        {
+            Function fn;
+            std::memcpy(&fn, p, sizeof(Function));
+            return fn(vm, static_cast<const char*>(p) + sizeof(Function));
+        }
+    };
+
+    /// ditto
+    template <class... Ts>
+    void pushValue(HSQUIRRELVM vm, const PropertyAccessor& val, Ts&&... values)
+    {
+        const auto usrData = static_cast<char*>(sq_newuserdata(vm, sizeof(PropertyAccessor::Function) + val.f.s));
+        std::memcpy(usrData, &val.fn, sizeof(PropertyAccessor::Function));
+        if (val.f.s > 0)
+        {
+            std::memcpy(usrData + sizeof(PropertyAccessor::Function), val.f.p, val.f.s);
+        }
+        pushValue(vm, std::forward<Ts>(values)...);
+    }
+
     /// ditto
     inline void pushValue(HSQUIRRELVM vm)
     {
@@ -203,6 +362,631 @@ namespace squeeze
         return getValue<const SQChar*>(vm, id);
     }
 
+    /// ditto
+    template <class T>
+    EnableStringView<T, T> getValue(HSQUIRRELVM vm, int id)
+    {
+        const auto str = getValue<const SQChar*>(vm, id);
+        return T(str, static_cast<size_t>(sq_getsize(vm, id)));
+    }
+
+    namespace detail
+    {
+        /**
+        The user pointer of an instance which refers to the object through a holder.
+        A holder checks the generation of a borrowed object, or owns the object by a smart pointer.
+        */
+        struct InstanceHolder
+        {
+            void* p = nullptr;
+            const std::uint32_t* generation = nullptr;
+            std::uint32_t expected = 0;
+            std::shared_ptr<void> owner;
+
+            virtual ~InstanceHolder() = default;
+        };
+
+        /** The holder which owns the object by a std::unique_ptr with a custom deleter */
+        template <class T, class D>
+        struct UniqueHolder : InstanceHolder
+        {
+            std::unique_ptr<T, D> ptr;
+        };
+
+        /** The release hook of all instances which have a holder */
+        inline SQInteger releaseHolder(SQUserPointer p, SQInteger)
+        {
+            delete static_cast<InstanceHolder*>(p);
+            return 0;
+        }
+
+        /** The release hook of instances which refer to objects owned by C++ */
+        inline SQInteger releaseNothing(SQUserPointer, SQInteger)
+        {
+            return 0;
+        }
+
+        /** Return the holder of the instance, or nullptr if the instance has no holder. */
+        inline InstanceHolder* getHolder(HSQUIRRELVM vm, int id, SQUserPointer up)
+        {
+            return sq_getreleasehook(vm, id) == releaseHolder ? static_cast<InstanceHolder*>(up) : nullptr;
+        }
+
+        /**
+        Resolve the user pointer of the instance to the object. Return false if the reference is stale.
+        Every instance which has an object has a release hook, so the user pointer of an instance without it is null.
+        The inline storage of an instance which is not constructed is not an object.
+        */
+        inline bool resolveInstance(HSQUIRRELVM vm, int id, SQUserPointer& up)
+        {
+            if (!sq_getreleasehook(vm, id))
+            {
+                up = nullptr;
+                return true;
+            }
+            if (const auto holder = getHolder(vm, id, up))
+            {
+                if (holder->generation && *holder->generation != holder->expected)
+                {
+                    return false;
+                }
+                up = holder->p;
+            }
+            return true;
+        }
+
+        /**
+        The offsets of base class subobjects, keyed by the type tags of a derived class and its base class.
+        Offsets are written only when classes are bound, so lookups take a shared lock.
+        */
+        struct BaseOffsets
+        {
+            std::shared_mutex mutex;
+            std::map<std::pair<SQUserPointer, SQUserPointer>, std::ptrdiff_t> offsets;
+
+            static BaseOffsets& instance()
+            {
+                static BaseOffsets bases;
+                return bases;
+            }
+        };
+
+        /** Whether 'Base' is a non-virtual base of 'Derived', which has a fixed offset */
+        template <class Derived, class Base, class = void>
+        struct IsFixedBase : std::false_type {};
+
+        template <class Derived, class Base>
+        struct IsFixedBase<Derived, Base, std::void_t<decltype(static_cast<Derived*>(std::declval<Base*>()))>> : std::true_type {};
+
+        /** Record the offset of 'Base' in 'Derived', and the offsets of the bases of 'Base' through it. */
+        template <class Derived, class Base>
+        void registerBase()
+        {
+            static_assert(IsFixedBase<Derived, Base>::value, "A virtual base class can not be bound.");
+
+            // The offset is measured on a dummy address, which is never dereferenced.
+            const auto derived = reinterpret_cast<Derived*>(static_cast<std::uintptr_t>(alignof(Derived)) << 8);
+            const auto offset = reinterpret_cast<const char*>(static_cast<Base*>(derived)) - reinterpret_cast<const char*>(derived);
+
+            const auto derivedTag = typeTag<Derived>();
+            const auto baseTag = typeTag<Base>();
+            auto& bases = BaseOffsets::instance();
+            std::unique_lock<std::shared_mutex> lock(bases.mutex);
+            bases.offsets[{ derivedTag, baseTag }] = offset;
+            for (auto it = bases.offsets.lower_bound({ baseTag, nullptr }); it != bases.offsets.end() && it->first.first == baseTag; ++it)
+            {
+                bases.offsets[{ derivedTag, it->first.second }] = offset + it->second;
+            }
+        }
+
+        /**
+        Convert the object of the instance at 'id' to its subobject of the class which has 'tag'.
+        The object of an instance is of the class of the instance, which may be derived from the requested class.
+        An instance of the requested class itself is returned without a lock.
+        */
+        inline SQUserPointer toBase(HSQUIRRELVM vm, int id, SQUserPointer p, SQUserPointer tag)
+        {
+            SQUserPointer actual;
+            if (!p || SQ_FAILED(sq_gettypetag(vm, id, &actual)) || actual == tag)
+            {
+                return p;
+            }
+
+            auto& bases = BaseOffsets::instance();
+            std::shared_lock<std::shared_mutex> lock(bases.mutex);
+            const auto it = bases.offsets.find({ actual, tag });
+            return it == bases.offsets.end() ? p : static_cast<char*>(p) + it->second;
+        }
+    }
+
+    /// ditto
+    template <class T>
+    EnableInstancePointer<T, T> getValue(HSQUIRRELVM vm, int id)
+    {
+        const auto tag = typeTag<std::remove_cv_t<std::remove_pointer_t<T>>>();
+        SQUserPointer p;
+        if (SQ_FAILED(sq_getinstanceup(vm, id, &p, tag)))
+        {
+            failed<StackOperationFailed>(vm, "sq_getinstanceup() failed.");
+        }
+        if (!detail::resolveInstance(vm, id, p))
+        {
+            throw StackOperationFailed("The instance refers to a stale object.");
+        }
+        return static_cast<T>(detail::toBase(vm, id, p, tag));
+    }
+
+    /// ditto
+    template <class T>
+    EnableInstanceReference<T, T> getValue(HSQUIRRELVM vm, int id)
+    {
+        const auto p = getValue<std::remove_reference_t<T>*>(vm, id);
+        if (!p)
+        {
+            throw StackOperationFailed("The instance has no object.");
+        }
+        return *p;
+    }
+
+    /// ditto
+    template <class T>
+    EnableSharedPointer<T, std::decay_t<T>> getValue(HSQUIRRELVM vm, int id)
+    {
+        using Element = typename std::decay_t<T>::element_type;
+
+        const auto tag = typeTag<std::remove_cv_t<Element>>();
+        SQUserPointer p;
+        if (SQ_FAILED(sq_getinstanceup(vm, id, &p, tag)))
+        {
+            failed<StackOperationFailed>(vm, "sq_getinstanceup() failed.");
+        }
+        const auto holder = detail::getHolder(vm, id, p);
+        if (!holder || !holder->owner)
+        {
+            throw StackOperationFailed("The instance is not shared with C++.");
+        }
+        return std::decay_t<T>(holder->owner, static_cast<Element*>(detail::toBase(vm, id, holder->p, tag)));
+    }
+
+    namespace detail
+    {
+        /** Return the absolute index of a stack position. */
+        inline SQInteger absIndex(HSQUIRRELVM vm, SQInteger id)
+        {
+            return id < 0 ? sq_gettop(vm) + id + 1 : id;
+        }
+
+        /** Copy elements of the array at 'id' to a range. */
+        template <class T, class It>
+        void getArray(HSQUIRRELVM vm, SQInteger id, SQInteger size, It out)
+        {
+            const auto top = sq_gettop(vm);
+            for (SQInteger i = 0; i < size; ++i, ++out)
+            {
+                sq_pushinteger(vm, i);
+                if (SQ_FAILED(sq_rawget(vm, id)))
+                {
+                    sq_settop(vm, top);
+                    failed<StackOperationFailed>(vm, "sq_rawget() failed.");
+                }
+                try
+                {
+                    *out = getValue<T>(vm, -1);
+                }
+                catch (...)
+                {
+                    sq_settop(vm, top);
+                    throw;
+                }
+                sq_poptop(vm);
+            }
+        }
+    }
+
+    /// ditto
+    template <class T>
+    auto getValue(HSQUIRRELVM vm, int id)
+        -> std::enable_if_t<IsVector<T>::value, std::decay_t<T>>
+    {
+        if (sq_gettype(vm, id) != OT_ARRAY)
+        {
+            failed<StackOperationFailed>(vm, "A type mismatching in getValue()");
+        }
+        const auto size = sq_getsize(vm, id);
+        std::decay_t<T> val(static_cast<size_t>(size));
+        detail::getArray<typename std::decay_t<T>::value_type>(vm, detail::absIndex(vm, id), size, val.begin());
+        return val;
+    }
+
+    /// ditto
+    template <class T>
+    auto getValue(HSQUIRRELVM vm, int id)
+        -> std::enable_if_t<IsStdArray<T>::value, std::decay_t<T>>
+    {
+        std::decay_t<T> val{};
+        if (sq_gettype(vm, id) != OT_ARRAY || sq_getsize(vm, id) != static_cast<SQInteger>(val.size()))
+        {
+            failed<StackOperationFailed>(vm, "A type mismatching in getValue()");
+        }
+        detail::getArray<typename std::decay_t<T>::value_type>(vm, detail::absIndex(vm, id), static_cast<SQInteger>(val.size()), val.begin());
+        return val;
+    }
+
+    namespace detail
+    {
+        /** The user data of a numeric buffer */
+        struct BufferData
+        {
+            void* data;
+            SQInteger size;
+            BufferType type;
+            bool readOnly;
+            std::shared_ptr<void> pin;
+        };
+    }
+
+    /// ditto
+    template <class T>
+    EnableBufferRef<T, std::decay_t<T>> getValue(HSQUIRRELVM vm, int id)
+    {
+        using Element = std::remove_pointer_t<decltype(std::decay_t<T>::data)>;
+
+        SQUserPointer p;
+        SQUserPointer tag;
+        if (SQ_FAILED(sq_getuserdata(vm, id, &p, &tag)) || tag != typeTag<detail::BufferData>())
+        {
+            failed<StackOperationFailed>(vm, "A type mismatching in getValue()");
+        }
+        const auto buf = static_cast<detail::BufferData*>(p);
+        if (buf->type != BufferTypeOf<Element>::value)
+        {
+            throw StackOperationFailed("The element type of the buffer is mismatched.");
+        }
+        if (buf->readOnly && !std::is_const<Element>::value)
+        {
+            throw StackOperationFailed("The buffer is read-only.");
+        }
+        return std::decay_t<T>(static_cast<Element*>(buf->data), static_cast<size_t>(buf->size), buf->pin);
+    }
+
+    namespace detail
+    {
+        template <class C>
+        auto reserve(C& c, size_t n, int) -> decltype(c.reserve(n), void())
+        {
+            c.reserve(n);
+        }
+
+        template <class C>
+        void reserve(C&, size_t, long)
+        {
+        }
+    }
+
+    /// ditto
+    template <class T>
+    EnableAssociative<T, std::decay_t<T>> getValue(HSQUIRRELVM vm, int id)
+    {
+        using Container = std::decay_t<T>;
+        using K = std::remove_const_t<typename Container::value_type::first_type>;
+        using V = typename Container::value_type::second_type;
+
+        if (sq_gettype(vm, id) != OT_TABLE)
+        {
+            failed<StackOperationFailed>(vm, "A type mismatching in getValue()");
+        }
+
+        Container val;
+        detail::reserve(val, static_cast<size_t>(sq_getsize(vm, id)), 0);
+
+        const auto table = detail::absIndex(vm, id);
+        const auto top = sq_gettop(vm);
+        sq_pushnull(vm);
+        try
+        {
+            while (SQ_SUCCEEDED(sq_next(vm, table)))
+            {
+                val.insert(val.end(), typename Container::value_type(getValue<K>(vm, -2), getValue<V>(vm, -1)));
+                sq_pop(vm, 2);
+            }
+        }
+        catch (...)
+        {
+            sq_settop(vm, top);
+            throw;
+        }
+        sq_settop(vm, top);
+        return val;
+    }
+
+    namespace detail
+    {
+        /** Read a field of a reflected struct from the table at 'table'. */
+        template <class T, class C, class M>
+        void getField(HSQUIRRELVM vm, SQInteger table, T& val, const Field<C, M>& field)
+        {
+            const auto top = sq_gettop(vm);
+            sq_pushstring(vm, field.name, field.length);
+            if (SQ_FAILED(sq_rawget(vm, table)))
+            {
+                sq_settop(vm, top);
+                failed<StackOperationFailed>(vm, "A field of the struct is missing.");
+            }
+            try
+            {
+                val.*field.member = getValue<M>(vm, -1);
+            }
+            catch (...)
+            {
+                sq_settop(vm, top);
+                throw;
+            }
+            sq_settop(vm, top);
+        }
+    }
+
+    /// ditto
+    template <class T>
+    EnableReflected<T, std::decay_t<T>> getValue(HSQUIRRELVM vm, int id)
+    {
+        if (sq_gettype(vm, id) != OT_TABLE)
+        {
+            failed<StackOperationFailed>(vm, "A type mismatching in getValue()");
+        }
+
+        std::decay_t<T> val{};
+        const auto table = detail::absIndex(vm, id);
+        std::apply([&](const auto&... field)
+        {
+            (detail::getField(vm, table, val, field), ...);
+        }, Reflect<std::decay_t<T>>::fields);
+        return val;
+    }
+
+    /**
+    Get the object of a class instance which type tag is of 'Class' or its base classes.
+    Return nullptr if the value is not such an instance, the instance has no object or refers to a stale object.
+    */
+    template <class Class>
+    Class* getInstance(HSQUIRRELVM vm, int id)
+    {
+        const auto tag = typeTag<std::remove_cv_t<Class>>();
+        SQUserPointer p;
+        if (SQ_FAILED(sq_getinstanceup(vm, id, &p, tag)) || !detail::resolveInstance(vm, id, p))
+        {
+            return nullptr;
+        }
+        return static_cast<Class*>(detail::toBase(vm, id, p, tag));
+    }
+
+    namespace detail
+    {
+        template <class T, class = void>
+        struct TypeMaskOf
+        {
+            static constexpr bool checked = false;
+            static constexpr SQChar value[] = SQZ_T(".");
+        };
+
+        template <class T>
+        struct TypeMaskOf<T, EnableInteger<T>>
+        {
+            static constexpr bool checked = true;
+            static constexpr SQChar value[] = SQZ_T("n|b");
+        };
+
+        template <class T>
+        struct TypeMaskOf<T, EnableReal<T>>
+        {
+            static constexpr bool checked = true;
+            static constexpr SQChar value[] = SQZ_T("n|b");
+        };
+
+        template <class T>
+        struct TypeMaskOf<T, EnableBool<T>>
+        {
+            static constexpr bool checked = true;
+            static constexpr SQChar value[] = SQZ_T("b|i");
+        };
+
+        template <class T>
+        struct TypeMaskOf<T, EnableChars<T>>
+        {
+            static constexpr bool checked = true;
+            static constexpr SQChar value[] = SQZ_T("s");
+        };
+
+        template <class T>
+        struct TypeMaskOf<T, EnableString<T>>
+        {
+            static constexpr bool checked = true;
+            static constexpr SQChar value[] = SQZ_T("s");
+        };
+
+        template <class T>
+        struct TypeMaskOf<T, EnableStringView<T>>
+        {
+            static constexpr bool checked = true;
+            static constexpr SQChar value[] = SQZ_T("s");
+        };
+
+        template <class T>
+        struct TypeMaskOf<T, EnableInstancePointer<T>>
+        {
+            static constexpr bool checked = false;
+            static constexpr SQChar value[] = SQZ_T("x");
+        };
+
+        template <class T>
+        struct TypeMaskOf<T, EnableInstanceReference<T>>
+        {
+            static constexpr bool checked = false;
+            static constexpr SQChar value[] = SQZ_T("x");
+        };
+
+        template <class T>
+        struct TypeMaskOf<T, EnableSequence<T>>
+        {
+            static constexpr bool checked = false;
+            static constexpr SQChar value[] = SQZ_T("a");
+        };
+
+        template <class T>
+        struct TypeMaskOf<T, EnableReflected<T>>
+        {
+            static constexpr bool checked = false;
+            static constexpr SQChar value[] = SQZ_T("t");
+        };
+
+        template <class T>
+        struct TypeMaskOf<T, EnableAssociative<T>>
+        {
+            static constexpr bool checked = false;
+            static constexpr SQChar value[] = SQZ_T("t");
+        };
+
+        template <class T>
+        struct TypeMaskOf<T, EnableBufferRef<T>>
+        {
+            static constexpr bool checked = false;
+            static constexpr SQChar value[] = SQZ_T("u");
+        };
+
+        template <class T>
+        struct TypeMaskOf<T, EnableSharedPointer<T>>
+        {
+            static constexpr bool checked = false;
+            static constexpr SQChar value[] = SQZ_T("x");
+        };
+
+        struct AnyMask
+        {
+            static constexpr SQChar value[] = SQZ_T(".");
+        };
+
+        struct InstanceMask
+        {
+            static constexpr SQChar value[] = SQZ_T("x");
+        };
+
+        template <class Array, size_t N>
+        constexpr void appendMask(Array& mask, size_t& length, const SQChar(&m)[N])
+        {
+            for (size_t i = 0; i < N - 1; ++i)
+            {
+                mask[length++] = m[i];
+            }
+        }
+
+        template <class... Masks>
+        struct JoinMasks
+        {
+            static constexpr size_t length = (size_t(0) + ... + (std::extent<decltype(Masks::value)>::value - 1));
+
+            static constexpr std::array<SQChar, length + 1> make()
+            {
+                std::array<SQChar, length + 1> mask{};
+                size_t n = 0;
+                (appendMask(mask, n, Masks::value), ...);
+                return mask;
+            }
+
+            static constexpr std::array<SQChar, length + 1> value = make();
+        };
+    }
+
+    /**
+    Create the parameter check of a closure.
+    'This' is the type mask of the environment object, and 'Args' are types of the following parameters.
+    The type mask string is built at compile time.
+    */
+    template <class This, class... Args>
+    ParamsCheck makeParamsCheck()
+    {
+        using Mask = detail::JoinMasks<This, detail::TypeMaskOf<Args>...>;
+        return{ static_cast<SQInteger>(sizeof...(Args) + 1), Mask::value.data() };
+    }
+
+    /**
+    Get a value from the stack which type is already checked by the VM.
+    The case of the type has no type mask, then this function is same as getValue().
+    */
+    template <class T>
+    auto fetchValue(HSQUIRRELVM vm, int id)
+        -> std::enable_if_t<!detail::TypeMaskOf<T>::checked, T>
+    {
+        return getValue<T>(vm, id);
+    }
+
+    /// ditto
+    template <class T>
+    EnableInteger<T, std::decay_t<T>> fetchValue(HSQUIRRELVM vm, int id)
+    {
+        SQInteger val;
+        if (SQ_FAILED(sq_getinteger(vm, id, &val)))
+        {
+            SQBool b;
+            sq_getbool(vm, id, &b);
+            val = b;
+        }
+        return static_cast<std::decay_t<T>>(val);
+    }
+
+    /// ditto
+    template <class T>
+    EnableReal<T, std::decay_t<T>> fetchValue(HSQUIRRELVM vm, int id)
+    {
+        SQFloat val;
+        if (SQ_FAILED(sq_getfloat(vm, id, &val)))
+        {
+            SQBool b;
+            sq_getbool(vm, id, &b);
+            val = static_cast<SQFloat>(b);
+        }
+        return static_cast<std::decay_t<T>>(val);
+    }
+
+    /// ditto
+    template <class T>
+    EnableBool<T, bool> fetchValue(HSQUIRRELVM vm, int id)
+    {
+        SQBool val;
+        if (SQ_FAILED(sq_getbool(vm, id, &val)))
+        {
+            SQInteger i;
+            sq_getinteger(vm, id, &i);
+            return i != 0;
+        }
+        return !!val;
+    }
+
+    /// ditto
+    template <class T>
+    EnableChars<T, const SQChar*> fetchValue(HSQUIRRELVM vm, int id)
+    {
+        const SQChar* val;
+        sq_getstring(vm, id, &val);
+        return val;
+    }
+
+    /// ditto
+    template <class T>
+    EnableString<T, string_t> fetchValue(HSQUIRRELVM vm, int id)
+    {
+        const SQChar* val;
+        sq_getstring(vm, id, &val);
+        return string_t(val, static_cast<size_t>(sq_getsize(vm, id)));
+    }
+
+    /// ditto
+    template <class T>
+    EnableStringView<T, string_view_t> fetchValue(HSQUIRRELVM vm, int id)
+    {
+        const SQChar* val;
+        sq_getstring(vm, id, &val);
+        return string_view_t(val, static_cast<size_t>(sq_getsize(vm, id)));
+    }
+
     /** Push the values as user datas */
     template <class T, class... Ts>
     void pushUserData(HSQUIRRELVM vm, std::pair<const T*, size_t> val, std::pair<const Ts*, size_t>... values)
@@ -3,6 +3,7 @@
 
 #include "sqzclosure.h"
 #include "sqztableimpl.h"
+#include "sqzkey.h"
 #include "sqzstackop.h"
 #include "sqzdef.h"
 #include "sqzutil.h"
@@ -13,6 +14,92 @@ namespace squeeze
 {
     template <class Class> class HClass;
 
+    /**
+    The builder which adds slots to a table in one stack session.
+    The table is pushed once, and the stack is restored once when the builder is destructed.
+    A failed insertion throws the same exception as HTable does.
+    */
+    class SlotBatch
+    {
+    private:
+        HSQUIRRELVM vm_;
+        SQInteger top_;
+
+        void newSlot()
+        {
+            if (SQ_FAILED(sq_newslot(vm_, top_ + 1, SQFalse)))
+            {
+                sq_settop(vm_, top_ + 1);
+                failed<ObjectHandlingFailed>(vm_, "sq_newslot() failed.");
+            }
+        }
+
+    public:
+        /** Push the table */
+        SlotBatch(HSQUIRRELVM vm, HSQOBJECT table)
+            : vm_(vm)
+            , top_(sq_gettop(vm))
+        {
+            // The table, a key, a value and a free variable of a closure.
+            sq_reservestack(vm_, 4);
+            sq_pushobject(vm_, table);
+        }
+
+        SlotBatch(const SlotBatch&) = delete;
+        SlotBatch& operator=(const SlotBatch&) = delete;
+
+        /** Restore the stack */
+        ~SlotBatch()
+        {
+            sq_settop(vm_, top_);
+        }
+
+        /** Add a new slot as a variable. */
+        template <class T>
+        SlotBatch& var(const Key& key, const T& val)
+        {
+            pushValue(vm_, key, val);
+            newSlot();
+            return *this;
+        }
+
+        /** Add a new slot as a table. */
+        SlotBatch& table(const Key& key, HSQOBJECT table)
+        {
+            pushValue(vm_, key, table);
+            newSlot();
+            return *this;
+        }
+
+        /** Add a new slot as a function. */
+        template <class F>
+        SlotBatch& fun(const Key& key, const F& f)
+        {
+            key.push(vm_);
+            if (!pushFunction(vm_, f))
+            {
+                sq_settop(vm_, top_ + 1);
+                failed<ObjectHandlingFailed>(vm_, "sq_setparamscheck() failed.");
+            }
+            newSlot();
+            return *this;
+        }
+
+        /** Add a new slot as a function which is bound at compile time. */
+        template <auto f>
+        SlotBatch& fun(const Key& key)
+        {
+            key.push(vm_);
+            if (!pushClosure(vm_, Closure::fixedFun<f>, Closure::funCheck<decltype(f)>()))
+            {
+                sq_settop(vm_, top_ + 1);
+                failed<ObjectHandlingFailed>(vm_, "sq_setparamscheck() failed.");
+            }
+            newSlot();
+            return *this;
+        }
+    };
+
     /** The Table object handle */
     class HTable : public HTableImpl
     {
@@ -31,6 +118,17 @@ namespace squeeze
             sq_settop(vm_, top);
         }
 
+        /** Create a table object which has room for 'capacity' slots */
+        HTable(HVM vm, SQInteger capacity)
+        {
+            vm_ = vm;
+            const auto top = sq_gettop(vm_);
+            sq_newtableex(vm_, capacity);
+            sq_getstackobj(vm_, -1, &obj_);
+            sq_addref(vm_, &obj_);
+            sq_settop(vm_, top);
+        }
+
         /** Create with copy the object handle */
         HTable(HVM vm, HSQOBJECT obj)
         {
@@ -49,37 +147,66 @@ namespace squeeze
 
         /** Add a new slot as a variable. */
         template <class T>
-        HTable& var(const string_t& key, const T& val)
+        HTable& var(const Key& key, const T& val)
         {
             newSlot(key, val, false);
             return *this;
         }
 
         /** Add a new slot as a table. */
-        HTable& table(const string_t& key, HTable table)
+        HTable& table(const Key& key, HTable table)
         {
             newSlot(key, table, false);
             return *this;
         }
 
+        /** Set a value to the slot mapped by 'key', or add a new slot. Delegates and metamethods are not used. */
+        template <class T>
+        HTable& rawSet(const Key& key, const T& val)
+        {
+            HTableImpl::rawSet(key, val);
+            return *this;
+        }
+
         /** Add a new slot as a class. */
         template <class Class>
-        HTable& clazz(const string_t& key, HClass<Class> c);
+        HTable& clazz(const Key& key, HClass<Class> c);
 
         /** Add a new slot as a function. */
         template <class F>
-        HTable& fun(const string_t& key, const F& f)
+        HTable& fun(const Key& key, const F& f)
+        {
+            newFunction(key, f, false);
+            return *this;
+        }
+
+        /** Add a new slot as a function which is bound at compile time. */
+        template <auto f>
+        HTable& fun(const Key& key)
         {
-            newClosure(key, Closure::fun<F>, false, UserData(&f, sizeof(F)));
+            newClosure(key, Closure::fixedFun<f>, Closure::funCheck<decltype(f)>(), false);
             return *this;
         }
 
+        /** Return the builder which adds slots in one stack session. */
+        SlotBatch batch()
+        {
+            return SlotBatch(vm_, obj_);
+        }
+
         /** Call a function mapped by 'key'. */
         template <class Return, class... Args>
-        Return call(const string_t& key, HTable env,  Args&&... args)
+        Return call(const Key& key, HTable env,  Args&&... args)
         {
             return HTableImpl::call<Return>(key, env, std::forward<Args>(args)...);
         }
+
+        /** Call a function mapped by 'key'. Delegates and metamethods are not used to find the function. */
+        template <class Return, class... Args>
+        Return rawCall(const Key& key, HTable env, Args&&... args)
+        {
+            return HTableImpl::rawCall<Return>(key, env, std::forward<Args>(args)...);
+        }
     };
 }
 
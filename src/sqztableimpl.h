@@ -2,13 +2,146 @@
 #define SQUEEZE_SQZTABLEIMPL_H
 
 #include "sqzobject.h"
+#include "sqzkey.h"
 #include "sqzstackop.h"
+#include "sqzbuffer.h"
+#include "sqzclosure.h"
 #include "sqzdef.h"
 #include <squirrel.h>
 #include <type_traits>
+#include <optional>
+#include <iterator>
+#include <cstddef>
 
 namespace squeeze
 {
+    /**
+    The view of a slot in an iterated table.
+    The key and the value are referred without adding references, so the view is valid while the slot exists.
+    */
+    class SlotView
+    {
+    private:
+        HSQUIRRELVM vm_;
+        HSQOBJECT key_;
+        HSQOBJECT value_;
+
+        template <class T>
+        T get(HSQOBJECT obj) const
+        {
+            sq_pushobject(vm_, obj);
+            try
+            {
+                auto val = getValue<T>(vm_, -1);
+                sq_poptop(vm_);
+                return val;
+            }
+            catch (...)
+            {
+                sq_poptop(vm_);
+                throw;
+            }
+        }
+
+        friend class SlotIterator;
+
+    public:
+        /** Return the key. */
+        template <class T>
+        T key() const
+        {
+            return get<T>(key_);
+        }
+
+        /** Return the value. */
+        template <class T>
+        T value() const
+        {
+            return get<T>(value_);
+        }
+
+        /** Return the type of the key. */
+        ObjectType keyType() const
+        {
+            return static_cast<ObjectType>(sq_type(key_));
+        }
+
+        /** Return the type of the value. */
+        ObjectType valueType() const
+        {
+            return static_cast<ObjectType>(sq_type(value_));
+        }
+    };
+
+    /** The iterator over slots of a table, which walks the table by sq_next() and allocates nothing. */
+    class SlotIterator
+    {
+    private:
+        HSQOBJECT table_;
+        HSQOBJECT iter_;
+        SlotView slot_;
+        bool end_;
+
+        void next()
+        {
+            const auto vm = slot_.vm_;
+            const auto top = sq_gettop(vm);
+            sq_pushobject(vm, table_);
+            sq_pushobject(vm, iter_);
+            if (SQ_SUCCEEDED(sq_next(vm, -2)))
+            {
+                sq_getstackobj(vm, -3, &iter_);
+                sq_getstackobj(vm, -2, &slot_.key_);
+                sq_getstackobj(vm, -1, &slot_.value_);
+            }
+            else
+            {
+                end_ = true;
+            }
+            sq_settop(vm, top);
+        }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = SlotView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const SlotView*;
+        using reference = const SlotView&;
+
+        /** Construct the end iterator */
+        SlotIterator()
+            : table_()
+            , iter_()
+            , slot_()
+            , end_(true)
+        {
+        }
+
+        /** Construct the iterator at the first slot */
+        SlotIterator(HSQUIRRELVM vm, HSQOBJECT table)
+            : table_(table)
+            , iter_()
+            , slot_()
+            , end_(false)
+        {
+            sq_resetobject(&iter_);
+            slot_.vm_ = vm;
+            next();
+        }
+
+        const SlotView& operator*() const { return slot_; }
+        const SlotView* operator->() const { return &slot_; }
+
+        SlotIterator& operator++()
+        {
+            next();
+            return *this;
+        }
+
+        bool operator==(const SlotIterator& that) const { return end_ && that.end_; }
+        bool operator!=(const SlotIterator& that) const { return !(*this == that); }
+    };
+
     /** The basic implementation of table object handlers */
     class HTableImpl : public HObject
     {
@@ -17,28 +150,104 @@ namespace squeeze
         Whether the object type mapped by 'key' is same to 'type' or not. 
         This function returns false if an object mapped by 'key' is not exist.
         */
-        bool is(ObjectType type, const string_t& key)
+        bool is(ObjectType type, const Key& key)
         {
-            bool isSame = false;
+            return isImpl(type, key, false);
+        }
+
+        /** Same as is(), but delegates and metamethods are not used to find the slot. */
+        bool rawIs(ObjectType type, const Key& key)
+        {
+            return isImpl(type, key, true);
+        }
+
+        /** Return the value mapped by 'key'. Throw an exception if the slot is not exist. */
+        template <class T>
+        T get(const Key& key)
+        {
+            return getImpl<T>(key, false);
+        }
+
+        /** Same as get(), but delegates and metamethods are not used to find the slot. */
+        template <class T>
+        T rawGet(const Key& key)
+        {
+            return getImpl<T>(key, true);
+        }
 
+        /** Return the value mapped by 'key', or nothing if the slot is not exist or the value is not of T. */
+        template <class T>
+        std::optional<T> tryGet(const Key& key)
+        {
+            std::optional<T> val;
             const auto top = sq_gettop(vm_);
-            pushValue(vm_, obj_, key);
-            if (SQ_SUCCEEDED(sq_get(vm_, -2)))
+            if (lookup(key, false))
             {
-                isSame = sq_gettype(vm_, -1) == static_cast<SQObjectType>(type);
+                try
+                {
+                    val = getValue<T>(vm_, -1);
+                }
+                catch (const StackOperationFailed&)
+                {
+                }
+            }
+            else
+            {
+                sq_reseterror(vm_);
             }
             sq_settop(vm_, top);
+            return val;
+        }
 
-            return isSame;
+        /** Return the iterator at the first slot. The table must not be changed while it is iterated. */
+        SlotIterator begin()
+        {
+            return SlotIterator(vm_, obj_);
+        }
+
+        /** Return the end iterator. */
+        SlotIterator end()
+        {
+            return SlotIterator();
         }
 
         /** Add a closure. */
         template <class... FreeVars>
-        void newClosure(const string_t& key, SQFUNCTION closure, bool bstatic, FreeVars&&... freeVars)
+        void newClosure(const Key& key, SQFUNCTION closure, bool bstatic, FreeVars&&... freeVars)
+        {
+            newClosure(key, closure, ParamsCheck{ 0, nullptr }, bstatic, std::forward<FreeVars>(freeVars)...);
+        }
+
+        /** Add a closure which parameters are checked by the VM. */
+        template <class... FreeVars>
+        void newClosure(const Key& key, SQFUNCTION closure, const ParamsCheck& check, bool bstatic, FreeVars&&... freeVars)
+        {
+            newClosureSlot(key, bstatic, [&]
+            {
+                return pushClosure(vm_, closure, check, std::forward<FreeVars>(freeVars)...);
+            });
+        }
+
+        /** Add a closure which calls a function. Stateless functions are bound without free variables. */
+        template <class F>
+        void newFunction(const Key& key, const F& f, bool bstatic)
+        {
+            newClosureSlot(key, bstatic, [&] { return pushFunction(vm_, f); });
+        }
+
+        /** Add a closure which calls a member function. Stateless functions are bound without free variables. */
+        template <class Class, class F>
+        void newMemberFunction(const Key& key, const F& f, bool bstatic)
+        {
+            newClosureSlot(key, bstatic, [&] { return pushMemberFunction<Class>(vm_, f); });
+        }
+
+    protected:
+        template <class T>
+        void newSlot(const Key& key, T&& val, bool bstatic)
         {
             const auto top = sq_gettop(vm_);
-            pushValue(vm_, obj_, key, std::forward<FreeVars>(freeVars)...);
-            sq_newclosure(vm_, closure, sizeof...(FreeVars));
+            pushValue(vm_, obj_, key, std::forward<T>(val));
             if (SQ_FAILED(sq_newslot(vm_, -3, bstatic)))
             {
                 sq_settop(vm_, top);
@@ -47,26 +256,92 @@ namespace squeeze
             sq_settop(vm_, top);
         }
 
-    protected:
         template <class T>
-        void newSlot(const string_t& key, T&& val, bool bstatic)
+        void rawSet(const Key& key, T&& val)
         {
             const auto top = sq_gettop(vm_);
             pushValue(vm_, obj_, key, std::forward<T>(val));
-            if (SQ_FAILED(sq_newslot(vm_, -3, bstatic)))
+            if (SQ_FAILED(sq_rawset(vm_, -3)))
             {
                 sq_settop(vm_, top);
-                failed<ObjectHandlingFailed>(vm_, "sq_newslot() failed.");
+                failed<ObjectHandlingFailed>(vm_, "sq_rawset() failed.");
+            }
+            sq_settop(vm_, top);
+        }
+
+        template <class Return, class... Args>
+        Return call(const Key& key, HSQOBJECT env, Args&&... args)
+        {
+            return invoke<Return>(key, false, env, std::forward<Args>(args)...);
+        }
+
+        template <class Return, class... Args>
+        Return rawCall(const Key& key, HSQOBJECT env, Args&&... args)
+        {
+            return invoke<Return>(key, true, env, std::forward<Args>(args)...);
+        }
+
+        void clone(HTableImpl* table)
+        {
+            release();
+            vm_ = table->vm_;
+            pushValue(vm_, *table);
+            sq_clone(vm_, -1);
+            sq_getstackobj(vm_, -1, &obj_);
+            sq_addref(vm_, &obj_);
+            sq_pop(vm_, 2);
+        }
+
+    private:
+        /** Push the value mapped by 'key' on the table. Return false if the slot is not exist. */
+        bool lookup(const Key& key, bool raw)
+        {
+            pushValue(vm_, obj_, key);
+            return SQ_SUCCEEDED(raw ? sq_rawget(vm_, -2) : sq_get(vm_, -2));
+        }
+
+        bool isImpl(ObjectType type, const Key& key, bool raw)
+        {
+            bool isSame = false;
+
+            const auto top = sq_gettop(vm_);
+            if (lookup(key, raw))
+            {
+                isSame = sq_gettype(vm_, -1) == static_cast<SQObjectType>(type);
             }
             sq_settop(vm_, top);
+
+            return isSame;
+        }
+
+        template <class T>
+        T getImpl(const Key& key, bool raw)
+        {
+            const auto top = sq_gettop(vm_);
+            if (!lookup(key, raw))
+            {
+                sq_settop(vm_, top);
+                failed<ObjectHandlingFailed>(vm_, raw ? "sq_rawget() failed." : "sq_get() failed.");
+            }
+            try
+            {
+                auto val = getValue<T>(vm_, -1);
+                sq_settop(vm_, top);
+                return val;
+            }
+            catch (...)
+            {
+                sq_settop(vm_, top);
+                throw;
+            }
         }
 
         template <class Return, class... Args>
-        auto call(const string_t& key, HSQOBJECT env, Args&&... args)
+        auto invoke(const Key& key, bool raw, HSQOBJECT env, Args&&... args)
             -> std::enable_if_t<std::is_void<Return>::value, void>
         {
             const auto top = sq_gettop(vm_);
-            if (!prepareCall(key, env, std::forward<Args>(args)...))
+            if (!prepareCall(key, raw, env, std::forward<Args>(args)...))
             {
                 sq_settop(vm_, top);
                 failed<CallFailed>(vm_, "sq_call() failed.");
@@ -80,11 +355,11 @@ namespace squeeze
         }
 
         template <class Return, class... Args>
-        auto call(const string_t& key, HSQOBJECT env, Args&&... args)
+        auto invoke(const Key& key, bool raw, HSQOBJECT env, Args&&... args)
             -> std::enable_if_t<!std::is_void<Return>::value, Return>
         {
             const auto top = sq_gettop(vm_);
-            if (!prepareCall(key, env, std::forward<Args>(args)...))
+            if (!prepareCall(key, raw, env, std::forward<Args>(args)...))
             {
                 sq_settop(vm_, top);
                 failed<CallFailed>(vm_, "sq_call() failed.");
@@ -99,23 +374,28 @@ namespace squeeze
             return ret;
         }
 
-        void clone(HTableImpl* table)
+        template <class Push>
+        void newClosureSlot(const Key& key, bool bstatic, Push&& push)
         {
-            release();
-            vm_ = table->vm_;
-            pushValue(vm_, *table);
-            sq_clone(vm_, -1);
-            sq_getstackobj(vm_, -1, &obj_);
-            sq_addref(vm_, &obj_);
-            sq_pop(vm_, 2);
+            const auto top = sq_gettop(vm_);
+            pushValue(vm_, obj_, key);
+            if (!push())
+            {
+                sq_settop(vm_, top);
+                failed<ObjectHandlingFailed>(vm_, "sq_setparamscheck() failed.");
+            }
+            if (SQ_FAILED(sq_newslot(vm_, -3, bstatic)))
+            {
+                sq_settop(vm_, top);
+                failed<ObjectHandlingFailed>(vm_, "sq_newslot() failed.");
+            }
+            sq_settop(vm_, top);
         }
 
-    private:
         template <class... Args>
-        bool prepareCall(const string_t& key, HSQOBJECT env, Args&&... args)
+        bool prepareCall(const Key& key, bool raw, HSQOBJECT env, Args&&... args)
         {
-            pushValue(vm_, obj_, key);
-            if (SQ_FAILED(sq_get(vm_, -2)))
+            if (!lookup(key, raw))
             {
                 return false;
             }
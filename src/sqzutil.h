@@ -59,6 +59,24 @@ namespace squeeze
     template <class F>
     using ClassType = typename FunctionTraits<F>::ClassType;
 
+    /**
+    Whether a callable type has no state or not.
+    Stateless callables are bound without free variables.
+    */
+    template <class F>
+    using IsStateless = std::integral_constant<bool, std::is_class<F>::value && std::is_empty<F>::value && std::is_trivially_copyable<F>::value>;
+
+    /**
+    Return the type tag of a bound class.
+    The tag is not const, so identical constants of other classes are never folded into the same address.
+    */
+    template <class Class>
+    SQUserPointer typeTag()
+    {
+        static char tag;
+        return &tag;
+    }
+
     /** The IndexSequence class. */
     template <size_t... Indices>
     struct IndexSequence
@@ -155,6 +173,19 @@ namespace squeeze
         return multi.data();
     }
 
+    /** Convert to the used character set. */
+    inline string_t widen(const std::string& s)
+    {
+#ifdef SQUNICODE
+        const auto length = s.length();
+        std::vector<wchar_t> wide(length + 1, L'\0');
+        std::mbstowcs(wide.data(), s.data(), length);
+        return wide.data();
+#else
+        return s;
+#endif
+    }
+
     /** Obtain last error message if exists. */
     inline string_t lastError(HSQUIRRELVM vm, const string_t& defaultMessage = SQZ_T(""))
     {
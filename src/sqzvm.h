@@ -93,6 +93,9 @@ namespace squeeze
             sq_poptop(vm_);
         }
 
+        /** Register the vectorized kernel library as the 'kernel' table */
+        void kernellib();
+
         /** Open a new VM */
         void open(size_t stackSize)
         {
@@ -0,0 +1,79 @@
+#include <squeeze.h>
+#include <CppUTest/CommandLineTestRunner.h>
+
+using namespace squeeze;
+
+TEST_GROUP(ARRAY)
+{
+};
+
+TEST(ARRAY, PUSH_POP)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HArray a(vm);
+    a.push(1).push(2.5f).push(string_t(SQZ_T("three")));
+    CHECK(a.size() == 3);
+    CHECK(a.at<int>(0) == 1);
+    CHECK(a.at<float>(1) == 2.5f);
+    CHECK(a.pop<string_t>() == SQZ_T("three"));
+    CHECK(a.size() == 2);
+
+    a.set(0, 10);
+    CHECK(a.at<int>(0) == 10);
+
+    a.resize(5);
+    CHECK(a.size() == 5);
+    CHECK_THROWS(ObjectHandlingFailed, a.at<int>(5));
+
+    vm.close();
+}
+
+TEST(ARRAY, BULK)
+{
+    HVM vm;
+    vm.open(1024);
+
+    const std::vector<float> samples = { 0.5f, 1.5f, 2.5f, 3.5f };
+
+    HArray a(vm, 2);
+    a.assign(samples.begin(), samples.end());
+    CHECK(a.size() == 4);
+
+    std::vector<float> out;
+    CHECK(a.copyTo(out) == 4);
+    CHECK(out == samples);
+
+    float head[2] = {};
+    CHECK(a.copyTo(Span<float>(head, 2)) == 2);
+    CHECK(head[1] == 1.5f);
+
+    vm.close();
+}
+
+TEST(ARRAY, CONVERSION)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HTable t(vm);
+    t.fun(SQZ_T("sum"), [](const std::vector<int>& v) { int s = 0; for (auto n : v) s += n; return s; });
+    t.fun(SQZ_T("twice"), [](std::array<int, 3> v) { for (auto& n : v) n *= 2; return v; });
+
+    const std::vector<int> v = { 1, 2, 3 };
+    CHECK(t.call<int>(SQZ_T("sum"), t, v) == 6);
+    CHECK(t.call<int>(SQZ_T("sum"), t, std::array<int, 2>{ { 4, 5 } }) == 9);
+
+    const int raw[] = { 7, 8 };
+    CHECK(t.call<int>(SQZ_T("sum"), t, Span<const int>(raw, 2)) == 15);
+
+    const auto doubled = t.call<std::vector<int>>(SQZ_T("twice"), t, v);
+    CHECK(doubled == std::vector<int>({ 2, 4, 6 }));
+    CHECK_THROWS(CallFailed, t.call<int>(SQZ_T("twice"), t, std::vector<int>{ 1, 2 }));
+
+    t.var(SQZ_T("list"), v);
+    CHECK(t.is(ObjectType::Array, SQZ_T("list")));
+
+    vm.close();
+}
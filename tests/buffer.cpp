@@ -0,0 +1,74 @@
+#include <squeeze.h>
+#include <CppUTest/CommandLineTestRunner.h>
+
+using namespace squeeze;
+
+TEST_GROUP(BUFFER)
+{
+};
+
+TEST(BUFFER, INDEX)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HScript script(vm);
+    HTable env(vm);
+
+    script.compileFile(SQZ_T("test.nut"));
+    script.run(env);
+
+    float samples[] = { 1.0f, 2.0f, 3.0f, 4.0f };
+    const BufferRef<float> buf(samples, 4);
+    CHECK(env.call<float>(SQZ_T("bufsum"), env, buf) == 10.0f);
+
+    env.call<void>(SQZ_T("bufscale"), env, buf, 2);
+    CHECK(samples[3] == 8.0f);
+
+    const std::int32_t counts[] = { 1, 2, 3 };
+    const BufferRef<const std::int32_t> readOnly(counts, 3);
+    CHECK(env.call<int>(SQZ_T("bufsum"), env, readOnly) == 6);
+    CHECK_THROWS(CallFailed, env.call<void>(SQZ_T("bufscale"), env, readOnly, 2));
+
+    vm.close();
+}
+
+TEST(BUFFER, ARGUMENT)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HTable t(vm);
+    t.fun(SQZ_T("first"), [](BufferRef<const double> b) { return b.data[0]; });
+    t.fun(SQZ_T("fill"), [](BufferRef<std::uint8_t> b, int v) { for (auto& e : b) e = static_cast<std::uint8_t>(v); });
+
+    double values[] = { 0.25, 0.5 };
+    CHECK(t.call<double>(SQZ_T("first"), t, BufferRef<double>(values, 2)) == 0.25);
+
+    std::uint8_t bytes[8] = {};
+    t.call<void>(SQZ_T("fill"), t, BufferRef<std::uint8_t>(bytes, 8), 7);
+    CHECK(bytes[7] == 7);
+
+    CHECK_THROWS(CallFailed, t.call<double>(SQZ_T("first"), t, BufferRef<std::uint8_t>(bytes, 8)));
+    CHECK_THROWS(CallFailed, t.call<void>(SQZ_T("fill"), t, BufferRef<const std::uint8_t>(bytes, 8), 7));
+
+    vm.close();
+}
+
+TEST(BUFFER, PIN)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HTable t(vm);
+
+    auto frame = std::make_shared<std::vector<float>>(16, 1.0f);
+    const std::weak_ptr<std::vector<float>> observer = frame;
+    t.var(SQZ_T("frame"), BufferRef<float>(frame));
+    frame.reset();
+    CHECK(!observer.expired());
+
+    t.release();
+    vm.close();
+    CHECK(observer.expired());
+}
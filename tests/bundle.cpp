@@ -0,0 +1,61 @@
+#include <squeeze.h>
+#include <sqzmapping.h>
+#include <CppUTest/CommandLineTestRunner.h>
+#include <filesystem>
+
+using namespace squeeze;
+
+TEST_GROUP(BUNDLE)
+{
+};
+
+TEST(BUNDLE, LOAD)
+{
+    HVM vm;
+    vm.open(1024);
+
+    const auto path = std::filesystem::temp_directory_path() / "squeeze_bundle_test.sqzb";
+    {
+        HScript test(vm);
+        test.compileFile(SQZ_T("test.nut"));
+        HScript twice(vm);
+        twice.compileBuffer(SQZ_T("function twice(x) { return x * 2; }"), SQZ_T("twice"));
+
+        BundleWriter writer;
+        writer.add(SQZ_T("test"), test).add(SQZ_T("twice"), twice);
+        CHECK(writer.size() == 2);
+        writer.write(path);
+    }
+
+    HBundle bundle(path);
+    CHECK(bundle.size() == 2);
+    CHECK(bundle.has(SQZ_T("test")));
+    CHECK(!bundle.has(SQZ_T("missing")));
+
+    HTable env(vm);
+    bundle.load(vm, SQZ_T("twice")).run(env);
+    CHECK(env.call<int>(SQZ_T("twice"), env, 21) == 42);
+    bundle.load(vm, SQZ_T("test")).run(env);
+    CHECK(env.call<int>(SQZ_T("foo"), env, 6) == 30);
+
+    CHECK_THROWS(ScriptException, bundle.load(vm, SQZ_T("missing")));
+
+    // The file is unmapped before it is removed.
+    bundle = HBundle();
+    std::filesystem::remove(path);
+
+    vm.close();
+}
+
+TEST(BUNDLE, BROKEN)
+{
+    const auto path = std::filesystem::temp_directory_path() / "squeeze_bundle_broken.sqzb";
+    auto bytes = BundleWriter().add(SQZ_T("empty"), std::vector<unsigned char>(8)).bytes();
+    bytes.resize(bytes.size() - 12);
+    CHECK(detail::writeFile(path, bytes));
+
+    CHECK_THROWS(ScriptException, HBundle{ path });
+    CHECK_THROWS(ScriptException, HBundle{ path.string() + ".missing" });
+
+    std::filesystem::remove(path);
+}
@@ -27,4 +27,45 @@ TEST(CLASS, SET_FUN)
     CHECK(c.is(ObjectType::HostFunction, SQZ_T("add")));
 
     vm.close();
-}
\ No newline at end of file
+}
+
+struct Named
+{
+    int id = 1;
+};
+
+struct Counter
+{
+    int count = 3;
+    int get() { return count; }
+};
+
+// Counter is not the first base, so its subobject is at a non-zero offset.
+struct Widget : Named, Counter
+{
+};
+
+TEST(CLASS, BASE_OFFSET)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HClass<Counter> counter(vm);
+    counter.fun(SQZ_T("get"), &Counter::get);
+
+    HClass<Widget> widget(counter);
+    widget.ctor<>();
+
+    auto root = vm.rootTable();
+    root.clazz(SQZ_T("Widget"), widget);
+    root.fun(SQZ_T("count"), [](Counter* c) { return c->count; });
+    root.fun(SQZ_T("countRef"), [](const Counter& c) { return c.count; });
+
+    HScript script(vm);
+    script.compileBuffer(SQZ_T("function run() { local w = Widget(); return w.get() + count(w) + countRef(w); }"), SQZ_T("base"));
+    script.run(root);
+
+    CHECK(root.call<int>(SQZ_T("run"), root) == 9);
+
+    vm.close();
+}
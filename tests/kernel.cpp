@@ -0,0 +1,103 @@
+#include <squeeze.h>
+#include <CppUTest/CommandLineTestRunner.h>
+
+using namespace squeeze;
+
+TEST_GROUP(KERNEL)
+{
+};
+
+TEST(KERNEL, OPERATIONS)
+{
+    // The size is not a multiple of vector widths, so remainders go through scalar loops.
+    std::vector<float> a(19), b(19);
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        a[i] = static_cast<float>(i);
+        b[i] = 2.0f;
+    }
+
+    kernel::add(a.data(), b.data(), a.size());
+    CHECK(a[18] == 20.0f);
+    kernel::mul(a.data(), b.data(), a.size());
+    CHECK(a[18] == 40.0f);
+    kernel::fma(a.data(), b.data(), b.data(), a.size());
+    CHECK(a[0] == 8.0f);
+    kernel::scale(a.data(), 0.5f, a.size());
+    CHECK(a[18] == 22.0f);
+    kernel::clamp(a.data(), 5.0f, 10.0f, a.size());
+    CHECK(a[0] == 5.0f && a[18] == 10.0f);
+
+    CHECK(kernel::sum(b.data(), b.size()) == 38.0);
+    CHECK(kernel::dot(b.data(), b.data(), b.size()) == 76.0);
+    CHECK(kernel::min(a.data(), a.size()) == 5.0f);
+    CHECK(kernel::max(a.data(), a.size()) == 10.0f);
+
+    const std::uint8_t bytes[] = { 200, 100, 3 };
+    CHECK(kernel::sum(bytes, 3) == 303);
+    CHECK(kernel::max(bytes, 3) == 200);
+}
+
+TEST(KERNEL, SIMD)
+{
+    // Reductions give the same result with or without the vector kernels.
+    std::vector<float> a(1003), b(1003);
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        a[i] = 1.0f / static_cast<float>(i + 1);
+        b[i] = static_cast<float>(i % 7) - 3.1f;
+    }
+    std::vector<double> c(a.begin(), a.end()), d(b.begin(), b.end());
+
+    const auto simd = kernel::useSimd(true);
+    const auto sum = kernel::sum(a.data(), a.size());
+    const auto dot = kernel::dot(a.data(), b.data(), a.size());
+    const auto dotd = kernel::dot(c.data(), d.data(), c.size());
+    const auto min = kernel::min(b.data(), b.size());
+
+    kernel::useSimd(false);
+    CHECK(!kernel::simdEnabled());
+    CHECK(kernel::sum(a.data(), a.size()) == sum);
+    CHECK(kernel::dot(a.data(), b.data(), a.size()) == dot);
+    CHECK(kernel::dot(c.data(), d.data(), c.size()) == dotd);
+    CHECK(kernel::min(b.data(), b.size()) == min);
+
+    kernel::useSimd(simd);
+}
+
+TEST(KERNEL, SCRIPT)
+{
+    HVM vm;
+    vm.open(1024);
+    vm.kernellib();
+
+    HScript script(vm);
+    HTable env(vm);
+
+    script.compileFile(SQZ_T("test.nut"));
+    script.run(env);
+
+    double values[] = { -1.0, 2.0, 4.0, 12.0, 6.0 };
+    CHECK(env.call<double>(SQZ_T("kernelnorm"), env, BufferRef<double>(values, 5)) == 1.0 + 4.0 + 25.0 + 9.0);
+    CHECK(values[0] == 0.0);
+
+    // Integer elements are scaled by real factors, and bounds are saturated to the element range.
+    std::uint8_t bytes[] = { 10, 5, 200 };
+    env.call<void>(SQZ_T("kernelscale"), env, BufferRef<std::uint8_t>(bytes, 3), 0.5);
+    CHECK(bytes[0] == 5 && bytes[1] == 3 && bytes[2] == 100);
+    env.call<void>(SQZ_T("kernelscale"), env, BufferRef<std::uint8_t>(bytes, 3), 3.0);
+    CHECK(bytes[0] == 15 && bytes[2] == 255);
+    env.call<void>(SQZ_T("kernelclamp"), env, BufferRef<std::uint8_t>(bytes, 3), -10, 300);
+    CHECK(bytes[0] == 15 && bytes[2] == 255);
+    env.call<void>(SQZ_T("kernelclamp"), env, BufferRef<std::uint8_t>(bytes, 3), 9.5, 20.5);
+    CHECK(bytes[0] == 15 && bytes[1] == 10 && bytes[2] == 20);
+
+    std::int32_t ints[] = { 3, -3 };
+    env.call<void>(SQZ_T("kernelscale"), env, BufferRef<std::int32_t>(ints, 2), 1.5);
+    CHECK(ints[0] == 5 && ints[1] == -5);
+
+    const double fixed[] = { 1.0 };
+    CHECK_THROWS(CallFailed, env.call<double>(SQZ_T("kernelnorm"), env, BufferRef<const double>(fixed, 1)));
+
+    vm.close();
+}
@@ -0,0 +1,110 @@
+#include <squeeze.h>
+#include <CppUTest/CommandLineTestRunner.h>
+#include <atomic>
+#include <thread>
+
+using namespace squeeze;
+
+TEST_GROUP(POOL)
+{
+};
+
+TEST(POOL, LEASE)
+{
+    int built = 0;
+    int resets = 0;
+    HVMPool pool(2, 1024, [&](HVM& vm)
+    {
+        vm.rootTable().var(SQZ_T("answer"), 42);
+        ++built;
+    }, [&](HVM&) { ++resets; });
+    CHECK(built == 2);
+
+    {
+        auto a = pool.lease();
+        CHECK(a->rootTable().get<int>(SQZ_T("answer")) == 42);
+        sq_pushinteger(a.vm(), 1);
+
+        auto b = pool.tryLease();
+        CHECK(b.has_value());
+        CHECK(!pool.tryLease().has_value());
+    }
+    CHECK(resets == 2);
+
+    auto c = pool.lease();
+    CHECK(sq_gettop(c.vm()) == 0);
+}
+
+TEST(POOL, THREADS)
+{
+    HVMPool pool(2, 1024, [](HVM& vm) { vm.rootTable().fun(SQZ_T("twice"), [](int n) { return n * 2; }); });
+
+    std::atomic<int> sum(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&pool, &sum, i]
+        {
+            for (int n = 0; n < 100; ++n)
+            {
+                auto lease = pool.lease();
+                auto root = lease->rootTable();
+                sum += root.call<int>(SQZ_T("twice"), root, i);
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    CHECK(sum == 2 * 100 * (0 + 1 + 2 + 3));
+}
+
+TEST(POOL, PIN)
+{
+    HVMPool pool(1, 1024, [](HVM&) {});
+
+    HSQUIRRELVM first = pool.pin();
+    HSQUIRRELVM second = pool.pin();
+    CHECK(first == second);
+    CHECK(!pool.tryLease().has_value());
+
+    pool.unpin();
+    CHECK(pool.tryLease().has_value());
+}
+
+TEST(POOL, RESET_FAILED)
+{
+    int built = 0;
+    bool fail = true;
+    HVMPool pool(1, 1024, [&](HVM& vm)
+    {
+        vm.rootTable().var(SQZ_T("answer"), 42);
+        ++built;
+    }, [&](HVM&)
+    {
+        if (fail)
+        {
+            throw std::runtime_error("reset failed");
+        }
+    });
+
+    // The VM is rebuilt, and returned to the pool.
+    std::optional<HTable> old;
+    {
+        auto lease = pool.lease();
+        old = lease->rootTable();
+    }
+    CHECK(built == 2);
+    CHECK(!old->vm().valid());
+    old.reset();
+    auto a = pool.tryLease();
+    CHECK(a.has_value());
+    CHECK((*a)->rootTable().get<int>(SQZ_T("answer")) == 42);
+    a.reset();
+    CHECK(built == 3);
+
+    fail = false;
+    pool.lease();
+    CHECK(built == 3);
+}
@@ -0,0 +1,53 @@
+#include <squeeze.h>
+#include <CppUTest/CommandLineTestRunner.h>
+#include <filesystem>
+
+using namespace squeeze;
+
+TEST_GROUP(PRECOMPILE)
+{
+};
+
+TEST(PRECOMPILE, COMPILE)
+{
+    HVM vm;
+    vm.open(1024);
+
+    // The second line is not an expression.
+    const auto broken = (std::filesystem::temp_directory_path() / "squeeze_broken.nut").generic_string<SQChar>();
+    const std::string source = "x <- 1\n)\n";
+    CHECK(detail::writeFile(broken, std::vector<unsigned char>(source.begin(), source.end())));
+
+    const std::vector<string_t> paths = { broken, SQZ_T("test.nut"), SQZ_T("missing.nut"), SQZ_T("test.nut") };
+
+    // The report is the same whatever the number of threads is.
+    for (const size_t threads : { 1, 4 })
+    {
+        const auto report = Precompiler(threads).compile(paths);
+        CHECK(!report.succeeded());
+        CHECK(report.scripts.size() == 4);
+        CHECK(report.scripts[0].bytecode.empty());
+        CHECK(!report.scripts[1].bytecode.empty());
+        CHECK(report.scripts[2].bytecode.empty());
+        CHECK(report.scripts[1].bytecode == report.scripts[3].bytecode);
+
+        CHECK(report.diagnostics.size() == 2);
+        CHECK(report.diagnostics[0].path == broken);
+        CHECK(report.diagnostics[0].line == 2);
+        CHECK(report.diagnostics[0].column == 2);
+        CHECK(report.diagnostics[0].message == "expression expected");
+        CHECK(report.diagnostics[1].path == SQZ_T("missing.nut"));
+    }
+    std::filesystem::remove(broken);
+
+    const auto report = Precompiler(2).compile({ SQZ_T("test.nut") });
+    CHECK(report.succeeded());
+
+    HScript script(vm);
+    HTable env(vm);
+    script.loadBytecode(report.scripts[0].bytecode);
+    script.run(env);
+    CHECK(env.call<int>(SQZ_T("foo"), env, 6) == 30);
+
+    vm.close();
+}
@@ -26,6 +26,120 @@ TEST(SCRIPT, COMPILE)
     vm.close();
 }
 
+TEST(SCRIPT, CACHE)
+{
+    HVM vm;
+    vm.open(1024);
+
+    const auto directory = std::filesystem::temp_directory_path() / "squeeze_cache_test";
+    std::filesystem::remove_all(directory);
+    BytecodeCache cache(directory);
+
+    // The first compilation writes the entry.
+    {
+        HScript script(vm);
+        HTable env(vm);
+
+        script.useCache(cache).compileFile(SQZ_T("test.nut"));
+        script.run(env);
+
+        CHECK(env.is(ObjectType::Function, SQZ_T("foo")));
+        CHECK(env.call<int>(SQZ_T("foo"), env, 6) == 30);
+    }
+    CHECK(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()) == 1);
+
+    // Replace the entry by other bytecode, so a cache hit is told from a recompilation.
+    std::vector<unsigned char> source;
+    CHECK(detail::readFile(SQZ_T("test.nut"), source));
+    {
+        HScript other(vm);
+        other.compileBuffer(SQZ_T("function foo(n) { return -n; }"), SQZ_T("cached"));
+        CHECK(detail::writeFile(cache.entry(SQZ_T("test.nut"), source), other.saveBytecode()));
+    }
+
+    // The second compilation loads the entry.
+    {
+        HScript script(vm);
+        HTable env(vm);
+
+        script.useCache(cache).compileFile(SQZ_T("test.nut"));
+        script.run(env);
+
+        CHECK(env.call<int>(SQZ_T("foo"), env, 6) == -6);
+        CHECK(!env.is(ObjectType::Function, SQZ_T("vecsum")));
+    }
+    CHECK(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()) == 1);
+
+    std::filesystem::remove_all(directory);
+    vm.close();
+}
+
+TEST(SCRIPT, BUFFER)
+{
+    HVM vm;
+    vm.open(1024);
+
+    const string_t source = SQZ_T("function twice(x) { return x * 2; }");
+
+    HScript script(vm);
+    HTable env(vm);
+    script.compileBuffer(source, SQZ_T("buffer"));
+    script.run(env);
+    CHECK(env.call<int>(SQZ_T("twice"), env, 4) == 8);
+
+    size_t pos = 0;
+    script.compile([&]() -> SQInteger { return pos < source.length() ? source[pos++] : 0; }, SQZ_T("reader"));
+    script.run(env);
+    CHECK(env.call<int>(SQZ_T("twice"), env, 5) == 10);
+
+    CHECK_THROWS(ScriptException, script.compileBuffer(SQZ_T("function ("), SQZ_T("broken")));
+
+    vm.close();
+}
+
+TEST(SCRIPT, BYTECODE)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HScript script(vm);
+    script.compileFile(SQZ_T("test.nut"));
+    const auto bytecode = script.saveBytecode();
+    CHECK(!bytecode.empty());
+
+    HScript loaded(vm);
+    HTable env(vm);
+    loaded.loadBytecode(bytecode);
+    loaded.run(env);
+    CHECK(env.call<int>(SQZ_T("foo"), env, 6) == 30);
+
+    const std::vector<unsigned char> broken(bytecode.begin(), bytecode.begin() + bytecode.size() / 2);
+    CHECK_THROWS(ScriptException, loaded.loadBytecode(broken));
+    CHECK_THROWS(ScriptException, HScript().saveBytecode());
+
+    vm.close();
+}
+
+TEST(SCRIPT, FUNCTION)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HScript script(vm);
+    HTable env(vm);
+
+    script.compileFile(SQZ_T("test.nut"));
+    script.run(env);
+
+    HFunction foo(env, SQZ_T("foo"));
+    CHECK(foo.call<int>(env, 6) == 30);
+    CHECK(foo.call<int>(env, 2) == 10);
+
+    CHECK_THROWS(ObjectHandlingFailed, HFunction(env, SQZ_T("integer")));
+
+    vm.close();
+}
+
 struct Vec
 {
     int x, y;
@@ -65,6 +179,7 @@ TEST(SCRIPT, CLASS)
     CHECK(env.call<int>(SQZ_T("vecsum"), env, 5, 2) == 7);
     CHECK(env.call<int>(SQZ_T("vecsum_withget"), env, 5, 2) == 12);
     CHECK(env.call<int>(SQZ_T("setget"), env, 5, 2) == 10);
+    CHECK(env.call<bool>(SQZ_T("setmismatch"), env));
 
     vm.close();
 }
@@ -94,6 +209,225 @@ TEST(SCRIPT, CLASS_LAMBDA)
     CHECK(env.call<int>(SQZ_T("vecsum"), env, 5, 2) == 7);
     CHECK(env.call<int>(SQZ_T("vecsum_withget"), env, 5, 2) == 12);
     CHECK(env.call<int>(SQZ_T("setget"), env, 5, 2) == 10);
+    CHECK(env.call<bool>(SQZ_T("setmismatch"), env));
+
+    vm.close();
+}
+
+TEST(SCRIPT, CLASS_FIXED)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HClass<Vec> c(vm);
+    c.ctor<int, int>();
+    c.fun<&Vec::sum>(SQZ_T("sum"));
+    c.setter<&Vec::setx>(SQZ_T("x"));
+    c.getter<&Vec::getx>(SQZ_T("x"));
+    c.prop<&Vec::gety, &Vec::sety>(SQZ_T("y"));
+
+    auto table = vm.rootTable();
+    table.clazz(SQZ_T("Vec2"), c);
+    table.fun(SQZ_T("getVec"), wrapConv(getVec, SQZ_T("Vec2")));
+
+    HScript script(vm);
+    HTable env(vm);
+
+    script.compileFile(SQZ_T("test.nut"));
+    script.run(env);
+
+    CHECK(env.call<int>(SQZ_T("vecsum"), env, 5, 2) == 7);
+    CHECK(env.call<int>(SQZ_T("vecsum_withget"), env, 5, 2) == 12);
+    CHECK(env.call<int>(SQZ_T("setget"), env, 5, 2) == 10);
+    CHECK(env.call<bool>(SQZ_T("setmismatch"), env));
 
     vm.close();
-}
\ No newline at end of file
+}
+
+TEST(SCRIPT, CLASS_INLINE)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HClass<Vec> c(vm);
+    c.inlineStorage();
+    c.ctor<int, int>();
+    c.fun<&Vec::sum>(SQZ_T("sum"));
+    c.prop<&Vec::getx, &Vec::setx>(SQZ_T("x"));
+    c.prop<&Vec::gety, &Vec::sety>(SQZ_T("y"));
+
+    auto table = vm.rootTable();
+    table.clazz(SQZ_T("Vec2"), c);
+    table.fun(SQZ_T("getVec"), wrapConv(getVec, SQZ_T("Vec2")));
+
+    HScript script(vm);
+    HTable env(vm);
+
+    script.compileFile(SQZ_T("test.nut"));
+    script.run(env);
+
+    CHECK(env.call<int>(SQZ_T("vecsum"), env, 5, 2) == 7);
+    CHECK(env.call<int>(SQZ_T("vecsum_withget"), env, 5, 2) == 12);
+    CHECK(env.call<int>(SQZ_T("setget"), env, 5, 2) == 10);
+    CHECK(env.call<bool>(SQZ_T("setmismatch"), env));
+
+    // The inline storage of an instance made without the constructor is not an object.
+    CHECK(env.call<bool>(SQZ_T("unconstructed"), env));
+
+    vm.close();
+}
+
+TEST(SCRIPT, CLASS_FIELD)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HClass<Vec> c(vm);
+    c.ctor<int, int>();
+    c.fun<&Vec::sum>(SQZ_T("sum"));
+    c.field(SQZ_T("x"), &Vec::x);
+    c.field(SQZ_T("y"), &Vec::y);
+
+    auto table = vm.rootTable();
+    table.clazz(SQZ_T("Vec2"), c);
+    table.fun(SQZ_T("getVec"), wrapConv(getVec, SQZ_T("Vec2")));
+
+    HScript script(vm);
+    HTable env(vm);
+
+    script.compileFile(SQZ_T("test.nut"));
+    script.run(env);
+
+    CHECK(env.call<int>(SQZ_T("vecsum"), env, 5, 2) == 7);
+    CHECK(env.call<int>(SQZ_T("setget"), env, 5, 2) == 10);
+    CHECK(env.call<bool>(SQZ_T("setmismatch"), env));
+
+    vm.close();
+}
+
+TEST(SCRIPT, CLASS_ARGUMENT)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HClass<Vec> c(vm);
+    c.ctor<int, int>();
+
+    auto table = vm.rootTable();
+    table.clazz(SQZ_T("Vec2"), c);
+    table.fun(SQZ_T("scale"), [](Vec* v, int s) { v->x *= s; v->y *= s; });
+    table.fun(SQZ_T("dot"), [](const Vec& a, const Vec& b) { return a.x * b.x + a.y * b.y; });
+
+    HScript script(vm);
+    HTable env(vm);
+
+    script.compileFile(SQZ_T("test.nut"));
+    script.run(env);
+
+    CHECK(env.call<int>(SQZ_T("vecarg"), env, 1, 2) == 20);
+    CHECK_THROWS(CallFailed, table.call<int>(SQZ_T("dot"), env, 1, 2));
+
+    vm.close();
+}
+
+TEST(SCRIPT, CLASS_RETURN)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HClass<Vec> c(vm);
+    c.ctor<int, int>();
+    c.fun<&Vec::sum>(SQZ_T("sum"));
+
+    auto table = vm.rootTable();
+    table.clazz(SQZ_T("Vec2"), c);
+    table.fun(SQZ_T("getVec"), &getVec);
+
+    HScript script(vm);
+    HTable env(vm);
+
+    script.compileFile(SQZ_T("test.nut"));
+    script.run(env);
+
+    env.var(SQZ_T("Vec2"), 0); // A shadowed class name does not change the returned type.
+    CHECK(env.call<int>(SQZ_T("vecsum_withget"), env, 5, 2) == 12);
+
+    vm.close();
+}
+
+TEST(SCRIPT, CLASS_REF)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HClass<Vec> c(vm);
+    c.fun<&Vec::sum>(SQZ_T("sum"));
+    c.field(SQZ_T("x"), &Vec::x);
+
+    auto table = vm.rootTable();
+    table.clazz(SQZ_T("Vec2"), c);
+
+    HScript script(vm);
+    HTable env(vm);
+
+    script.compileFile(SQZ_T("test.nut"));
+    script.run(env);
+
+    Vec v(5, 2);
+    std::uint32_t generation = 0;
+    env.var(SQZ_T("v"), ClassRef<Vec>{ &v, &generation });
+
+    CHECK(env.call<int>(SQZ_T("refsum"), env) == 7);
+    v.x = 10;
+    CHECK(env.call<int>(SQZ_T("refsum"), env) == 12);
+
+    ++generation;
+    CHECK_THROWS(CallFailed, env.call<int>(SQZ_T("refsum"), env));
+
+    vm.close();
+}
+
+static std::shared_ptr<Vec> kept;
+
+TEST(SCRIPT, CLASS_SHARED)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HClass<Vec> c(vm);
+    c.fun<&Vec::sum>(SQZ_T("sum"));
+
+    auto table = vm.rootTable();
+    table.clazz(SQZ_T("Vec2"), c);
+    table.fun(SQZ_T("keep"), [](std::shared_ptr<Vec> v) { kept = v; });
+    table.fun(SQZ_T("getVec"), [](int x, int y) { return std::make_unique<Vec>(x, y); });
+
+    HScript script(vm);
+    HTable env(vm);
+
+    script.compileFile(SQZ_T("test.nut"));
+    script.run(env);
+
+    auto v = std::make_shared<Vec>(5, 2);
+    env.var(SQZ_T("v"), v);
+    CHECK(env.call<int>(SQZ_T("refsum"), env) == 7);
+    CHECK(env.call<bool>(SQZ_T("same"), env, v, v));
+
+    table.call<void>(SQZ_T("keep"), env, v);
+    CHECK(kept == v);
+    kept.reset();
+
+    CHECK(env.call<int>(SQZ_T("vecsum_withget"), env, 5, 2) == 7);
+
+    // Entries of released instances are purged, so the cache does not keep every object ever pushed.
+    for (int i = 0; i < 100; ++i)
+    {
+        env.var(SQZ_T("temporary"), std::make_shared<Vec>(i, i));
+    }
+    detail::pushSharedInstances(vm);
+    CHECK(sq_getsize(vm, -1) < 32);
+    sq_poptop(vm);
+
+    vm.close();
+    CHECK(v.use_count() == 1);
+}
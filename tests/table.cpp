@@ -1,5 +1,6 @@
 #include <squeeze.h>
 #include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestMemoryAllocator.h>
 
 using namespace squeeze;
 
@@ -55,6 +56,8 @@ TEST(TABLE, SET_TABLE)
 
 void testfun() {};
 
+int twice(int n) { return n * 2; }
+
 TEST(TABLE, SET_FUN)
 {
     HVM vm;
@@ -66,4 +69,356 @@ TEST(TABLE, SET_FUN)
     CHECK(t.is(ObjectType::HostFunction, SQZ_T("Fun")));
 
     vm.close();
-}
\ No newline at end of file
+}
+
+TEST(TABLE, FIXED_FUN)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HTable t(vm);
+
+    t.fun<&twice>(SQZ_T("Twice"));
+    t.fun(SQZ_T("Triple"), [](int n) { return n * 3; });
+
+    CHECK(t.is(ObjectType::HostFunction, SQZ_T("Twice")));
+    CHECK(t.call<int>(SQZ_T("Twice"), t, 3) == 6);
+    CHECK(t.call<int>(SQZ_T("Triple"), t, 3) == 9);
+
+    vm.close();
+}
+
+TEST(TABLE, PARAMS_CHECK)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HTable t(vm);
+
+    t.fun(SQZ_T("Twice"), [](int n) { return n * 2; });
+    CHECK(t.call<int>(SQZ_T("Twice"), t, 3) == 6);
+    CHECK(t.call<int>(SQZ_T("Twice"), t, 3.0f) == 6);
+    CHECK(t.call<int>(SQZ_T("Twice"), t, true) == 2);
+    CHECK_THROWS(CallFailed, t.call<int>(SQZ_T("Twice"), t, SQZ_T("3")));
+    CHECK_THROWS(CallFailed, t.call<int>(SQZ_T("Twice"), t, 3, 4));
+
+    vm.close();
+}
+
+TEST(TABLE, KEY)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HTable t(vm);
+    HKey intKey(vm, SQZ_T("Int"));
+    HKey funKey(vm, SQZ_T("Fun"));
+
+    t.var(intKey, 1);
+    t.fun(funKey, &testfun);
+
+    CHECK(t.is(ObjectType::Integer, intKey));
+    CHECK(t.is(ObjectType::Integer, SQZ_T("Int")));
+    CHECK(t.is(ObjectType::HostFunction, funKey));
+
+    vm.close();
+}
+
+class CountingNewAllocator : public TestMemoryAllocator
+{
+private:
+    TestMemoryAllocator* original_;
+
+public:
+    int count;
+
+    explicit CountingNewAllocator(TestMemoryAllocator* original)
+        : TestMemoryAllocator(original->name(), original->alloc_name(), original->free_name())
+        , original_(original)
+        , count(0)
+    {
+    }
+
+    char* alloc_memory(size_t size, const char* file, int line) override
+    {
+        ++count;
+        return original_->alloc_memory(size, file, line);
+    }
+
+    void free_memory(char* memory, const char* file, int line) override
+    {
+        original_->free_memory(memory, file, line);
+    }
+};
+
+TEST(TABLE, NO_ALLOCATION)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HTable t(vm);
+    t.fun(SQZ_T("a_function_name_longer_than_small_string_buffers"), [](string_view_t s, int n) { return s.length() * n; });
+
+    const auto original = getCurrentNewAllocator();
+    CountingNewAllocator counter(original);
+    setCurrentNewAllocator(&counter);
+
+    const auto isFun = t.is(ObjectType::HostFunction, SQZ_T("a_function_name_longer_than_small_string_buffers"));
+    const auto ret = t.call<int>(SQZ_T("a_function_name_longer_than_small_string_buffers"), t, SQZ_T("12345"), 2);
+    const auto retView = t.call<int>(string_view_t(SQZ_T("a_function_name_longer_than_small_string_buffers")), t, string_view_t(SQZ_T("123")), 2);
+
+    setCurrentNewAllocator(original);
+
+    CHECK(isFun);
+    CHECK(ret == 10);
+    CHECK(retView == 6);
+    CHECK_EQUAL(0, counter.count);
+
+    vm.close();
+}
+
+TEST(TABLE, CHAR_ARRAY)
+{
+    HVM vm;
+    vm.open(1024);
+
+    // Arrays which are larger than their strings must not carry the trailing nulls.
+    const SQChar key[16] = SQZ_T("name");
+    const SQChar value[16] = SQZ_T("value");
+
+    HTable t(vm);
+    t.var(key, value);
+
+    CHECK(t.is(ObjectType::String, SQZ_T("name")));
+    CHECK(t.get<string_t>(SQZ_T("name")) == SQZ_T("value"));
+
+    vm.close();
+}
+
+TEST(TABLE, MAP)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HTable t(vm, 4);
+    t.fun(SQZ_T("count"), [](const std::unordered_map<string_t, int>& m) { return static_cast<int>(m.size()); });
+    t.fun(SQZ_T("invert"), [](const std::map<string_t, int>& m)
+    {
+        std::vector<std::pair<int, string_t>> inv;
+        for (const auto& slot : m)
+        {
+            inv.emplace_back(slot.second, slot.first);
+        }
+        return inv;
+    });
+
+    const std::map<string_t, int> m = { { SQZ_T("one"), 1 }, { SQZ_T("two"), 2 } };
+    CHECK(t.call<int>(SQZ_T("count"), t, m) == 2);
+
+    auto inv = t.call<std::map<int, string_t>>(SQZ_T("invert"), t, m);
+    CHECK(inv.size() == 2);
+    CHECK(inv[2] == SQZ_T("two"));
+
+    auto pairs = t.call<std::vector<std::pair<int, string_t>>>(SQZ_T("invert"), t, m);
+    CHECK(pairs.size() == 2);
+
+    t.var(SQZ_T("map"), m);
+    CHECK(t.is(ObjectType::Table, SQZ_T("map")));
+    CHECK_THROWS(CallFailed, t.call<int>(SQZ_T("count"), t, 1));
+
+    vm.close();
+}
+
+TEST(TABLE, GET)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HTable t(vm);
+    t.var(SQZ_T("Int"), 5);
+    t.var(SQZ_T("String"), string_t(SQZ_T("A")));
+
+    CHECK(t.get<int>(SQZ_T("Int")) == 5);
+    CHECK(t.get<string_t>(SQZ_T("String")) == SQZ_T("A"));
+    CHECK_THROWS(ObjectHandlingFailed, t.get<int>(SQZ_T("NotExist")));
+    CHECK_THROWS(StackOperationFailed, t.get<int>(SQZ_T("String")));
+
+    CHECK(t.tryGet<int>(SQZ_T("Int")) == 5);
+    CHECK(!t.tryGet<int>(SQZ_T("NotExist")));
+    CHECK(!t.tryGet<int>(SQZ_T("String")));
+
+    vm.close();
+}
+
+TEST(TABLE, ITERATE)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HTable t(vm);
+    for (int i = 0; i < 10; ++i)
+    {
+        t.var(string_t(1, static_cast<SQChar>(SQZ_T('a') + i)), i * i);
+    }
+    t.var(SQZ_T("Name"), SQZ_T("squares"));
+
+    const auto top = sq_gettop(vm);
+    int sum = 0;
+    int strings = 0;
+    for (const auto& slot : t)
+    {
+        CHECK(slot.keyType() == ObjectType::String);
+        if (slot.valueType() == ObjectType::Integer)
+        {
+            const int i = slot.key<string_view_t>()[0] - SQZ_T('a');
+            CHECK(slot.value<int>() == i * i);
+            sum += slot.value<int>();
+        }
+        else
+        {
+            CHECK(slot.key<string_view_t>() == SQZ_T("Name"));
+            CHECK(slot.value<string_view_t>() == SQZ_T("squares"));
+            ++strings;
+        }
+    }
+    CHECK(sum == 285);
+    CHECK(strings == 1);
+    CHECK(sq_gettop(vm) == top);
+
+    vm.close();
+}
+
+struct Extent
+{
+    int width;
+    int height;
+};
+
+struct Layer
+{
+    string_t name;
+    Extent extent;
+    float opacity;
+};
+
+namespace squeeze
+{
+    template <>
+    struct Reflect<Extent>
+    {
+        static constexpr auto fields = std::make_tuple(
+            makeField(SQZ_T("width"), &Extent::width),
+            makeField(SQZ_T("height"), &Extent::height));
+    };
+
+    template <>
+    struct Reflect<Layer>
+    {
+        static constexpr auto fields = std::make_tuple(
+            makeField(SQZ_T("name"), &Layer::name),
+            makeField(SQZ_T("extent"), &Layer::extent),
+            makeField(SQZ_T("opacity"), &Layer::opacity));
+    };
+}
+
+TEST(TABLE, REFLECT)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HTable t(vm);
+    t.fun(SQZ_T("area"), [](const Layer& l) { return l.extent.width * l.extent.height; });
+    t.fun(SQZ_T("grow"), [](std::vector<Layer> layers)
+    {
+        for (auto& l : layers)
+        {
+            l.extent.width *= 2;
+        }
+        return layers;
+    });
+
+    const Layer layer = { SQZ_T("base"), { 4, 3 }, 0.5f };
+    CHECK(t.call<int>(SQZ_T("area"), t, layer) == 12);
+
+    const auto grown = t.call<std::vector<Layer>>(SQZ_T("grow"), t, std::vector<Layer>{ layer, layer });
+    CHECK(grown.size() == 2);
+    CHECK(grown[1].name == SQZ_T("base"));
+    CHECK(grown[1].extent.width == 8);
+    CHECK(grown[1].opacity == 0.5f);
+
+    t.var(SQZ_T("extent"), Extent{ 1, 2 });
+    CHECK(t.get<Extent>(SQZ_T("extent")).height == 2);
+    // A struct whose fields do not match is raised as a Squirrel error, and the VM is still usable.
+    const auto top = sq_gettop(vm);
+    CHECK_THROWS(CallFailed, t.call<int>(SQZ_T("area"), t, Extent{ 1, 2 }));
+    CHECK(sq_gettop(vm) == top);
+    CHECK(t.call<int>(SQZ_T("area"), t, layer) == 12);
+
+    vm.close();
+}
+
+TEST(TABLE, BATCH)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HTable t(vm);
+    HTable sub(vm);
+
+    const auto top = sq_gettop(vm);
+    t.batch()
+        .var(SQZ_T("Int"), 1)
+        .var(SQZ_T("String"), SQZ_T("A"))
+        .table(SQZ_T("Table"), sub)
+        .fun(SQZ_T("twice"), [](int n) { return n * 2; })
+        .fun<twice>(SQZ_T("fixed"));
+    CHECK(sq_gettop(vm) == top);
+
+    CHECK(t.is(ObjectType::Integer, SQZ_T("Int")));
+    CHECK(t.is(ObjectType::String, SQZ_T("String")));
+    CHECK(t.is(ObjectType::Table, SQZ_T("Table")));
+    CHECK(t.call<int>(SQZ_T("twice"), t, 4) == 8);
+    CHECK(t.call<int>(SQZ_T("fixed"), t, 4) == 8);
+
+    {
+        auto batch = t.batch();
+        batch.var(SQZ_T("Real"), 1.5f);
+        CHECK(sq_gettop(vm) == top + 1);
+    }
+    CHECK(sq_gettop(vm) == top);
+    CHECK(t.is(ObjectType::Real, SQZ_T("Real")));
+
+    vm.close();
+}
+
+TEST(TABLE, RAW)
+{
+    HVM vm;
+    vm.open(1024);
+
+    HTable parent(vm);
+    parent.var(SQZ_T("Inherited"), 1);
+    parent.fun(SQZ_T("twice"), &twice);
+
+    HTable t(vm);
+    sq_pushobject(vm, t);
+    sq_pushobject(vm, parent);
+    sq_setdelegate(vm, -2);
+    sq_poptop(vm);
+
+    t.rawSet(SQZ_T("Own"), 2).rawSet(SQZ_T("Own"), 3);
+
+    CHECK(t.is(ObjectType::Integer, SQZ_T("Inherited")));
+    CHECK_FALSE(t.rawIs(ObjectType::Integer, SQZ_T("Inherited")));
+    CHECK(t.rawIs(ObjectType::Integer, SQZ_T("Own")));
+
+    CHECK(t.get<int>(SQZ_T("Inherited")) == 1);
+    CHECK(t.rawGet<int>(SQZ_T("Own")) == 3);
+    CHECK_THROWS(ObjectHandlingFailed, t.rawGet<int>(SQZ_T("Inherited")));
+
+    CHECK(t.call<int>(SQZ_T("twice"), t, 2) == 4);
+    CHECK_THROWS(CallFailed, t.rawCall<int>(SQZ_T("twice"), t, 2));
+    CHECK(parent.rawCall<int>(SQZ_T("twice"), t, 2) == 4);
+
+    vm.close();
+}
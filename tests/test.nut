@@ -24,4 +24,84 @@ function setget(x, y)
     v.y = y
     v.x = x
     return v.x * v.y
-}
\ No newline at end of file
+}
+
+function setmismatch()
+{
+    local v = Vec2(0, 0)
+    try
+    {
+        v.x = "text"
+    }
+    catch (e)
+    {
+        return v.x == 0
+    }
+    return false
+}
+
+function unconstructed()
+{
+    local v = Vec2.instance()
+    try
+    {
+        v.sum()
+    }
+    catch (e)
+    {
+        return true
+    }
+    return false
+}
+
+function vecarg(x, y)
+{
+    local v = Vec2(x, y)
+    scale(v, 2)
+    return dot(v, v)
+}
+
+function refsum()
+{
+    return v.sum()
+}
+
+function same(a, b)
+{
+    return a == b
+}
+
+function bufsum(b)
+{
+    local sum = 0.0
+    foreach (v in b)
+    {
+        sum += v
+    }
+    return sum
+}
+
+function bufscale(b, k)
+{
+    for (local i = 0; i < b.len(); ++i)
+    {
+        b[i] *= k
+    }
+}
+
+function kernelnorm(b)
+{
+    kernel.clamp(b, 0, 10)
+    kernel.scale(b, 0.5)
+    return kernel.dot(b, b)
+}
+
+function kernelscale(b, k)
+{
+    kernel.scale(b, k)
+}
+
+function kernelclamp(b, lo, hi)
+{
+    kernel.clamp(b, lo, hi)
+}
@@ -0,0 +1,139 @@
+#include <squeeze.h>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace squeeze;
+
+namespace fs = std::filesystem;
+
+void usage()
+{
+    std::fprintf(stderr,
+        "usage: sqzc [-j threads] [-o bundle | -d directory] script...\n"
+        "  -j threads    the number of worker threads (default: the number of hardware threads)\n"
+        "  -o bundle     write all scripts to a bundle\n"
+        "  -d directory  write .cnut files to a directory (default: next to the scripts)\n");
+}
+
+int main(int argc, char* argv[])
+{
+    size_t threads = 0;
+    fs::path bundle;
+    fs::path directory;
+    std::vector<string_t> paths;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if ((arg == "-j" || arg == "-o" || arg == "-d") && i + 1 < argc)
+        {
+            const char* value = argv[++i];
+            if (arg == "-j")
+            {
+                threads = static_cast<size_t>(std::strtoul(value, nullptr, 10));
+            }
+            else if (arg == "-o")
+            {
+                bundle = value;
+            }
+            else
+            {
+                directory = value;
+            }
+        }
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            usage();
+            return 2;
+        }
+        else
+        {
+            paths.push_back(fs::path(arg).string<SQChar>());
+        }
+    }
+    if (paths.empty() || (!bundle.empty() && !directory.empty()))
+    {
+        usage();
+        return 2;
+    }
+
+    Precompiler precompiler(threads);
+    const auto report = precompiler.compile(paths);
+
+    for (const auto& d : report.diagnostics)
+    {
+        const auto path = fs::path(d.path).string();
+        if (d.line > 0)
+        {
+            std::fprintf(stderr, "%s:%lld:%lld: error: %s\n", path.c_str(),
+                static_cast<long long>(d.line), static_cast<long long>(d.column), d.message.c_str());
+        }
+        else
+        {
+            std::fprintf(stderr, "%s: error: %s\n", path.c_str(), d.message.c_str());
+        }
+    }
+    if (!report.succeeded())
+    {
+        return 1;
+    }
+
+    try
+    {
+        if (!bundle.empty())
+        {
+            BundleWriter writer;
+            for (const auto& s : report.scripts)
+            {
+                // Modules are named by their paths without the extension.
+                writer.add(fs::path(s.path).replace_extension().generic_string<SQChar>(), s.bytecode);
+            }
+            writer.write(bundle);
+        }
+        else
+        {
+            // Outputs are checked before any of them is written.
+            std::vector<fs::path> outs;
+            for (const auto& s : report.scripts)
+            {
+                fs::path out = fs::path(s.path).replace_extension(".cnut");
+                if (!directory.empty())
+                {
+                    // Paths are mirrored under the directory, so they must not climb out of it.
+                    const auto relative = out.relative_path().lexically_normal();
+                    if (relative.empty() || *relative.begin() == "..")
+                    {
+                        std::fprintf(stderr, "%s: error: The output is outside the directory.\n", fs::path(s.path).string().c_str());
+                        return 1;
+                    }
+                    out = directory / relative;
+                }
+                outs.push_back(out);
+            }
+
+            for (size_t i = 0; i < outs.size(); ++i)
+            {
+                if (!directory.empty())
+                {
+                    fs::create_directories(outs[i].parent_path());
+                }
+                if (!detail::writeFile(outs[i], report.scripts[i].bytecode))
+                {
+                    std::fprintf(stderr, "%s: error: The bytecode can not be written.\n", outs[i].string().c_str());
+                    return 1;
+                }
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "error: %s\n", e.what());
+        return 1;
+    }
+
+    std::printf("%zu scripts compiled with %zu threads\n", report.scripts.size(), precompiler.threads());
+    return 0;
+}